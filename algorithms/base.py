@@ -3,17 +3,189 @@
 Copyright (c) 2025 Konrad Rieck. MIT License
 """
 
+import numpy as np
+
+
+def count_above(values, thresholds):
+    """Count values strictly above each threshold using a single sort."""
+    values = np.sort(np.asarray(values, dtype=float))
+    return len(values) - np.searchsorted(values, thresholds, side="right")
+
+
+def signs(x, threshold):
+    """Sign of each sample relative to the threshold: 1 above, -1 below, 0 equal"""
+    x = np.asarray(x)
+    return (x > threshold).astype(np.int8) - (x < threshold).astype(np.int8)
+
+
+def crossings(state):
+    """Indices of rising and falling edges of a sign sequence starting below"""
+    # Samples equal to the threshold keep the previous state
+    nonzero = np.flatnonzero(state)
+    values = state[nonzero]
+    previous = np.concatenate(([-1], values[:-1]))
+    rising = nonzero[(values > 0) & (previous < 0)]
+    falling = nonzero[(values < 0) & (previous > 0)]
+    return rising, falling
+
+
+def spaced_steps(events, min_step, last):
+    """Count events at least min_step after the previously counted event"""
+    steps = 0
+    for i in events.tolist():
+        if i - last >= min_step:
+            steps += 1
+            last = i
+
+    return steps
+
+
+def spaced_events(events, min_step, last):
+    """Indices of events at least min_step after the previously counted event"""
+    counted = []
+    for i in events.tolist():
+        if i - last >= min_step:
+            counted.append(i)
+            last = i
+
+    return np.array(counted, dtype=int)
+
+
+def bounded_steps(events, n, min_step, max_step, last):
+    """Count spaced events and retract a step once its gaps exceed max_step"""
+    steps = 0
+    last1 = last2 = last
+    for i in events.tolist():
+        # Retraction at the first sample of the gap beyond max_step
+        if last1 - last2 > max_step and last1 + max_step + 1 < i:
+            steps -= 1
+            last1 = last2
+
+        if i - last1 >= min_step:
+            steps += 1
+            last2 = last1
+            last1 = i
+
+        if i - last1 > max_step and last1 - last2 > max_step:
+            steps -= 1
+            last1 = last2
+
+    # Retraction in the gap after the last event
+    if last1 - last2 > max_step and last1 + max_step + 1 < n:
+        steps -= 1
+
+    return steps
+
+
+def bounded_events(events, n, min_step, max_step, last):
+    """Indices of spaced events that are not retracted as in bounded_steps"""
+    # A retraction always removes the most recently counted event
+    counted = []
+    last1 = last2 = last
+    for i in events.tolist():
+        if last1 - last2 > max_step and last1 + max_step + 1 < i:
+            counted.pop()
+            last1 = last2
+
+        if i - last1 >= min_step:
+            counted.append(i)
+            last2 = last1
+            last1 = i
+
+        if i - last1 > max_step and last1 - last2 > max_step:
+            counted.pop()
+            last1 = last2
+
+    if last1 - last2 > max_step and last1 + max_step + 1 < n:
+        counted.pop()
+
+    return np.array(counted, dtype=int)
+
 
 class BaseDetector:
     """Base class for step detection algorithms."""
 
+    # Parameter that sweep_steps() evaluates in one pass (None if unsupported)
+    sweep_param = None
+
+    # Parameters the preprocessing stage depends on, so that calibration
+    # caches one stage per recording and values of these parameters (none by
+    # default); fused detectors in lockstep.py do not use the stage
+    stage_params = ()
+
     def __init__(self, **params):
         # Initialize detector with parameters
         self.params = params
 
+    def reset(self):
+        # Override in subclasses to start a new stream, called by __init__
+        raise NotImplementedError("Subclasses must implement reset")
+
+    def feed(self, chunk):
+        # Override in subclasses to detect steps on the next chunk of samples
+        raise NotImplementedError("Subclasses must implement feed")
+
+    @property
+    def count(self):
+        # Steps detected on all samples fed since the last reset
+        return self.steps
+
     def detect_steps(self, mag_series):
-        # Override in subclasses to implement step detection
-        raise NotImplementedError("Subclasses must implement detect_steps")
+        # Detect steps on a complete series as one chunk of a new stream
+        self.reset()
+        self.feed(mag_series)
+        return self.count
+
+    def preprocess(self, mag_series):
+        # Override in staged subclasses to compute the preprocessing stage
+        return mag_series
+
+    def detect_preprocessed(self, signal):
+        # Override in staged subclasses to detect steps on the preprocessed signal
+        return self.detect_steps(signal)
+
+    def count_steps(self, mag_series):
+        # Count steps with the fast path of preprocess and detect_preprocessed,
+        # which must match detect_steps exactly (see verify.py)
+        return self.detect_preprocessed(self.preprocess(mag_series))
+
+    def events_preprocessed(self, signal):
+        # Override in subclasses to get the sample indices at which the counted
+        # steps are detected on the preprocessed signal
+        raise NotImplementedError("Subclasses must implement events_preprocessed")
+
+    def detect_events(self, mag_series):
+        # Sample indices at which a live detector counts each step, one per step
+        # of count_steps, computed apart from the count-only path
+        return self.events_preprocessed(self.preprocess(mag_series))
+
+    def get_lookahead(self):
+        # Override in subclasses that count a step only some samples after the
+        # sample that caused it
+        return 0
+
+    def native_steps(self, mag_series):
+        # Override in subclasses with C bindings to count steps natively, which
+        # must match detect_steps exactly
+        raise NotImplementedError("Subclasses must implement native_steps")
+
+    def sweep_steps(self, signal, values):
+        # Override in subclasses to count steps for all values of sweep_param
+        # on the preprocessed signal
+        raise NotImplementedError("Subclasses must implement sweep_steps")
+
+    def lockstep_params(self):
+        # Override in threshold detectors to describe them as a bounded threshold
+        # detector for the fused kernel in lockstep.py (None if unsupported)
+        return None
+
+    @classmethod
+    def get_cost(cls, params):
+        # Override in subclasses to estimate the cost on the watch: operations per
+        # sample and bytes of state of a plain C port with 16-bit samples and
+        # counters; cycles measured on the device are out of scope, as no
+        # detector runs on the watch yet
+        return {"ops": None, "state": None}
 
     @classmethod
     def get_param_grid(cls):
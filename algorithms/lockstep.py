@@ -0,0 +1,88 @@
+"""Lockstep evaluation of threshold detectors in one pass over a signal.
+
+Copyright (c) 2025 Konrad Rieck. MIT License
+"""
+
+import numpy as np
+
+# Maximum step size of detectors that never retract steps
+UNBOUNDED = 2**40
+
+
+class Lockstep:
+    """Run threshold detectors in lockstep with their state as arrays.
+
+    Each detector is a bounded threshold detector given by lockstep_params():
+    threshold on the signal shifted right by shift bits, minimum and maximum
+    step size, initial last step and whether only rising edges count.
+    """
+
+    def __init__(self, detectors):
+        params = [detector.lockstep_params() for detector in detectors]
+        self.threshold = np.array([p["threshold"] for p in params], dtype=float)
+        self.min_step = np.array([p["min_step"] for p in params], dtype=np.int64)
+        self.max_step = np.array([p["max_step"] for p in params], dtype=np.int64)
+        self.initial = np.array([p["initial"] for p in params], dtype=np.int64)
+        self.edge = np.array([p["edge"] for p in params], dtype=bool)
+        self.shifts, self.column = np.unique(
+            [p["shift"] for p in params], return_inverse=True
+        )
+
+    def candidates(self, x):
+        """Signals of all shifts at samples reaching any threshold"""
+        x = np.asarray(x, dtype=float)
+        signals = [x // 2**shift for shift in self.shifts.tolist()]
+
+        # Samples below all thresholds only end edges and advance time
+        mask = np.zeros(len(x), dtype=bool)
+        for k, signal in enumerate(signals):
+            mask |= signal >= self.threshold[self.column == k].min()
+        index = np.flatnonzero(mask)
+        return index, np.stack([signal[index] for signal in signals], axis=1)
+
+    def run(self, x):
+        """Count steps of all detectors on a signal"""
+        threshold, min_step, max_step = self.threshold, self.min_step, self.max_step
+        steps = np.zeros(len(threshold), dtype=np.int64)
+        last1, last2 = self.initial.copy(), self.initial.copy()
+        above = np.zeros(len(threshold), dtype=bool)
+
+        # Skip edge tracking and retractions if no detector needs them
+        edge = self.edge if self.edge.any() else None
+        bounded = bool((max_step < UNBOUNDED).any())
+
+        index, values = self.candidates(x)
+        prev = -1
+        for i, row in zip(index.tolist(), values):
+            value = row[self.column]
+            over = value > threshold
+
+            if bounded:
+                # Retraction in the gap since the previous candidate
+                late = (last1 - last2 > max_step) & (last1 + max_step + 1 < i)
+                steps -= late
+                np.copyto(last1, last2, where=late)
+
+            # Rising edges or all samples above the threshold are events
+            event = over
+            if edge is not None:
+                if i > prev + 1:
+                    above[:] = False
+                event = over & ~(above & edge)
+                above = over | (above & (value >= threshold))
+
+            accept = event & (i - last1 >= min_step)
+            steps += accept
+            np.copyto(last2, last1, where=accept)
+            np.copyto(last1, i, where=accept)
+
+            if bounded:
+                # Reduce step count if step is too large
+                late = (i - last1 > max_step) & (last1 - last2 > max_step)
+                steps -= late
+                np.copyto(last1, last2, where=late)
+            prev = i
+
+        # Retraction in the gap after the last candidate
+        late = (last1 - last2 > max_step) & (last1 + max_step + 1 < len(x))
+        return steps - late
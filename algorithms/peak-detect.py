@@ -6,82 +6,160 @@ Copyright (c) 2025 Konrad Rieck. MIT License
 import numpy as np
 
 from .base import BaseDetector
+from .filters import centered_means, prefix_sums, running_stats, window_stats
 
 
 class PeakDetect(BaseDetector):
     """Step detection algorithm based on peak detection."""
 
+    stage_params = ("mean_win",)
+
     def __init__(self, mean_win=12, detect_win=12, bounce_win=3, thres=1.2, **params):
         super().__init__(**params)
         self.mean_win = mean_win
         self.detect_win = detect_win
         self.bounce_win = bounce_win
         self.thres = thres
-
-    def calc_mean_diffs(self, x):
-        """Calculate mean differences with neighbors."""
-        n = len(x)
-        diffs = np.zeros(n)
-
-        for i in range(n):
-            start = max(0, i - self.mean_win)
-            end = min(n, i + self.mean_win + 1)
-            diffs[i] = x[i] - np.mean(x[start:end])
-
-        return diffs
+        self.reset()
+
+    def reset(self):
+        """Start a new stream of samples."""
+        # Samples are buffered from index base, differences from index first
+        self.samples = np.zeros(0)
+        self.base = 0
+        self.length = 0
+        self.diffs = np.zeros(0)
+        self.sums = np.zeros(1)
+        self.squares = np.zeros(1)
+        self.first = 0
+        self.done = 0
+        self.steps = 0
+        self.last_outlier = None
+
+    def mean_diffs(self, lo, hi):
+        """Calculate mean differences of buffered samples lo to hi."""
+        # Windows are truncated at both ends of the stream seen so far
+        index = np.arange(lo, hi) - self.base
+        means = centered_means(self.samples, self.mean_win, index)
+        return self.samples[index] - means
 
     def find_outliers(self, x):
         """Find outlier points using running statistics."""
-        outliers = []
-
-        # Pre-compute rolling means and stds using numpy
-        window_size = 2 * self.detect_win + 1
-        weights = np.ones(window_size)
-        means = np.convolve(x, weights / weights.sum(), mode="same")
-
-        # Calculate rolling std using vectorized operations
-        x2 = np.convolve(x**2, weights / weights.sum(), mode="same")
-        stds = np.sqrt(x2 - means**2)
-
-        # Find outliers using vectorized comparison
-        mask = (x - means) > (self.thres * stds)
-        outliers = np.where(mask)[0].tolist()
-
-        return outliers
-
-    def filter_bounces(self, outliers, diffs):
-        """Remove bounce artifacts by keeping strongest peaks in groups."""
-        if not outliers:
-            return []
-
-        # Convert to numpy array for faster operations
-        outliers = np.array(outliers)
-
-        # Calculate differences between consecutive outliers
-        gaps = np.diff(outliers)
-
-        # Find where groups start (gap >= bounce_win)
-        group_starts = np.where(gaps >= self.bounce_win)[0] + 1
-
-        # Add start and end indices to get complete groups
-        group_indices = np.concatenate(([0], group_starts, [len(outliers)]))
+        means, stds = window_stats(x, self.detect_win)
+        return np.flatnonzero((x - means) > (self.thres * stds))
+
+    def stream_outliers(self, start, end, diffs, sums, squares):
+        """Find outliers from start to end with prefix sums of differences."""
+        index = np.arange(start, end)
+        means, stds = running_stats(
+            sums, squares, index, self.detect_win, self.length, self.first
+        )
+        x = diffs[index - self.first]
+        return index[(x - means) > (self.thres * stds)].tolist()
+
+    def extend(self, diffs):
+        """Append differences and continue their prefix sums."""
+        sums = prefix_sums(diffs, self.sums[-1])[1:]
+        squares = prefix_sums(diffs**2, self.squares[-1])[1:]
+        return (
+            np.concatenate((self.diffs, diffs)),
+            np.concatenate((self.sums, sums)),
+            np.concatenate((self.squares, squares)),
+        )
+
+    def count_groups(self, outliers, steps, last):
+        """Count groups of outliers separated by at least the bounce window."""
+        for outlier in outliers:
+            if last is None or outlier - last >= self.bounce_win:
+                steps += 1
+            last = outlier
+        return steps, last
+
+    def feed(self, chunk):
+        """Buffer samples and finalize outliers whose windows are complete."""
+        chunk = np.asarray(chunk, dtype=float)
+        self.samples = np.concatenate((self.samples, chunk))
+        self.length += len(chunk)
+
+        # Differences are final once their mean window is complete
+        final = self.length - self.mean_win
+        known = self.first + len(self.diffs)
+        if final > known:
+            diffs = self.mean_diffs(known, final)
+            self.diffs, self.sums, self.squares = self.extend(diffs)
+
+        # Outliers are final once their detection window is complete
+        end = final - self.detect_win
+        if end <= self.done:
+            return
+        outliers = self.stream_outliers(
+            self.done, end, self.diffs, self.sums, self.squares
+        )
+        self.steps, self.last_outlier = self.count_groups(
+            outliers, self.steps, self.last_outlier
+        )
+        self.done = end
+
+        # Drop samples and differences left of the windows still needed
+        base = max(0, final - self.mean_win)
+        self.samples = self.samples[base - self.base :]
+        self.base = base
+        first = max(0, self.done - self.detect_win)
+        self.diffs = self.diffs[first - self.first :]
+        self.sums = self.sums[first - self.first :]
+        self.squares = self.squares[first - self.first :]
+        self.first = first
+
+    @property
+    def count(self):
+        """Count steps with outliers near the end of the stream so far."""
+        if self.length == self.done:
+            return self.steps
+
+        # Differences and outliers near the end use truncated windows
+        known = self.first + len(self.diffs)
+        diffs, sums, squares = self.extend(self.mean_diffs(known, self.length))
+        outliers = self.stream_outliers(self.done, self.length, diffs, sums, squares)
+        steps, _ = self.count_groups(outliers, self.steps, self.last_outlier)
+        return steps
+
+    def preprocess(self, mag_series):
+        """Calculate mean differences once per mean window with cumulative sums."""
+        x = np.asarray(mag_series, dtype=float)
+        return x - centered_means(x, self.mean_win)
+
+    def detect_preprocessed(self, diffs):
+        """Detect steps on precomputed mean differences."""
+        # Bounce filtering keeps one peak per group of close outliers
+        outliers = self.find_outliers(diffs)
+        if len(outliers) == 0:
+            return 0
+        return 1 + int(np.count_nonzero(np.diff(outliers) >= self.bounce_win))
 
-        # Process each group to keep strongest peak
-        filtered = []
-        for start, end in zip(group_indices[:-1], group_indices[1:]):
-            group = outliers[start:end]
-            # Get strongest peak in group
-            strongest = group[np.argmax(diffs[group])]
-            filtered.append(strongest)
+    def events_preprocessed(self, diffs):
+        """Get indices at which the first outlier of each group becomes final."""
+        outliers = self.find_outliers(diffs)
+        first = outliers[np.diff(outliers, prepend=-self.bounce_win) >= self.bounce_win]
+        return np.minimum(first + self.get_lookahead(), len(diffs) - 1)
 
-        return filtered
+    def get_lookahead(self):
+        """Both centered windows must be complete before an outlier is final."""
+        return self.mean_win + self.detect_win
 
-    def detect_steps(self, mag_series):
-        """Detect steps using peak detection algorithm."""
-        diffs = self.calc_mean_diffs(mag_series)
-        outliers = self.find_outliers(diffs)
-        peaks = self.filter_bounces(outliers, diffs)
-        return len(peaks)
+    @classmethod
+    def get_cost(cls, params):
+        # Running sums over both centered windows: update the mean sum, divide
+        # and subtract (4), square and update both deviation sums (5), mean,
+        # variance and square root (5), scale, subtract and compare (3), and
+        # bounce filtering (2); ring buffers hold the samples of the mean
+        # window and the differences of the detection window next to the
+        # sums, last outlier and count
+        mean_len = 2 * params["mean_win"] + 1
+        detect_len = 2 * params["detect_win"] + 1
+        return {
+            "ops": 19,
+            "state": 2 * mean_len + 2 * detect_len + 16,
+        }
 
     @classmethod
     def get_param_grid(cls):
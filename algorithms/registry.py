@@ -19,8 +19,14 @@ def discover_algorithms():
 
     # Iterate through all Python files in the algorithms directory
     for file_path in algorithms_dir.glob("*.py"):
-        # Skip __init__.py, base.py, and registry.py
-        if file_path.name in ["__init__.py", "base.py", "registry.py"]:
+        # Skip modules of shared helpers and the registry itself
+        if file_path.name in [
+            "__init__.py",
+            "base.py",
+            "filters.py",
+            "lockstep.py",
+            "registry.py",
+        ]:
             continue
 
         # Import the module
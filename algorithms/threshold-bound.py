@@ -5,7 +5,7 @@ Copyright (c) 2025 Konrad Rieck. MIT License
 
 import numpy as np
 
-from .base import BaseDetector
+from .base import BaseDetector, bounded_events, bounded_steps
 
 
 class ThresholdBound(BaseDetector):
@@ -16,29 +16,68 @@ class ThresholdBound(BaseDetector):
         self.threshold = threshold
         self.min_step = min_step
         self.max_step = max_step
+        self.reset()
 
-    def detect_steps(self, x):
-        """Detect steps with bounded step size and edge detection."""
-        steps = 0
-        last_step1 = -self.min_step
-        last_step2 = last_step1
+    def reset(self):
+        """Reset the stream."""
+        self.steps = 0
+        self.index = 0
+        self.last_step1 = -self.min_step
+        self.last_step2 = self.last_step1
 
-        for i in range(0, len(x)):
-            if x[i] > self.threshold:
-                if i - last_step1 >= self.min_step:
-                    steps += 1
-                    last_step2 = last_step1
-                    last_step1 = i
+    def feed(self, chunk):
+        """Detect steps with bounded step size in the next chunk."""
+        for value in np.asarray(chunk, dtype=float).tolist():
+            i = self.index
+            self.index += 1
+
+            if value > self.threshold:
+                if i - self.last_step1 >= self.min_step:
+                    self.steps += 1
+                    self.last_step2 = self.last_step1
+                    self.last_step1 = i
 
             # Reduce step count if step is too large
             if (
-                i - last_step1 > self.max_step
-                and last_step1 - last_step2 > self.max_step
+                i - self.last_step1 > self.max_step
+                and self.last_step1 - self.last_step2 > self.max_step
             ):
-                steps -= 1
-                last_step1 = last_step2
+                self.steps -= 1
+                self.last_step1 = self.last_step2
+
+    def preprocess(self, x):
+        """Convert the signal to an array once per recording."""
+        return np.asarray(x, dtype=float)
+
+    def detect_preprocessed(self, x):
+        """Detect steps by visiting only samples above the threshold."""
+        events = np.flatnonzero(x > self.threshold)
+        return bounded_steps(
+            events, len(x), self.min_step, self.max_step, -self.min_step
+        )
+
+    def events_preprocessed(self, x):
+        """Get indices of spaced samples above the threshold that are not retracted."""
+        events = np.flatnonzero(x > self.threshold)
+        return bounded_events(
+            events, len(x), self.min_step, self.max_step, -self.min_step
+        )
 
-        return steps
+    def lockstep_params(self):
+        """Describe the detector for the fused threshold kernel."""
+        return {
+            "threshold": self.threshold,
+            "shift": 0,
+            "min_step": self.min_step,
+            "max_step": self.max_step,
+            "initial": -self.min_step,
+            "edge": False,
+        }
+
+    @classmethod
+    def get_cost(cls, params):
+        # Compare, gap check, count and two gap checks
+        return {"ops": 10, "state": 8}
 
     @classmethod
     def get_param_grid(cls):
@@ -3,7 +3,9 @@
 Copyright (c) 2025 Konrad Rieck. MIT License
 """
 
-from .base import BaseDetector
+import numpy as np
+
+from .base import BaseDetector, bounded_events, bounded_steps
 
 
 class ThresholdBound8(BaseDetector):
@@ -14,30 +16,68 @@ class ThresholdBound8(BaseDetector):
         self.threshold = threshold
         self.min_step = min_step
         self.max_step = max_step
+        self.reset()
 
-    def detect_steps(self, x):
-        """Detect steps with bounded step size and edge detection."""
-        steps = 0
-        last_step1 = -self.min_step
-        last_step2 = last_step1
+    def reset(self):
+        """Reset the stream."""
+        self.steps = 0
+        self.index = 0
+        self.last_step1 = -self.min_step
+        self.last_step2 = self.last_step1
 
-        for i in range(0, len(x)):
-            mag = x[i] // 256
+    def feed(self, chunk):
+        """Detect steps with bounded step size in the next chunk."""
+        for value in np.asarray(chunk, dtype=float).tolist():
+            i = self.index
+            self.index += 1
+            mag = value // 256
             if mag > self.threshold:
-                if i - last_step1 >= self.min_step:
-                    steps += 1
-                    last_step2 = last_step1
-                    last_step1 = i
+                if i - self.last_step1 >= self.min_step:
+                    self.steps += 1
+                    self.last_step2 = self.last_step1
+                    self.last_step1 = i
 
             # Reduce step count if step is too large
             if (
-                i - last_step1 > self.max_step
-                and last_step1 - last_step2 > self.max_step
+                i - self.last_step1 > self.max_step
+                and self.last_step1 - self.last_step2 > self.max_step
             ):
-                steps -= 1
-                last_step1 = last_step2
+                self.steps -= 1
+                self.last_step1 = self.last_step2
+
+    def preprocess(self, x):
+        """Reduce the signal to 8 bits once per recording."""
+        return np.asarray(x, dtype=float) // 256
+
+    def detect_preprocessed(self, mag):
+        """Detect steps by visiting only samples above the threshold."""
+        events = np.flatnonzero(mag > self.threshold)
+        return bounded_steps(
+            events, len(mag), self.min_step, self.max_step, -self.min_step
+        )
+
+    def events_preprocessed(self, mag):
+        """Get indices of spaced samples above the threshold that are not retracted."""
+        events = np.flatnonzero(mag > self.threshold)
+        return bounded_events(
+            events, len(mag), self.min_step, self.max_step, -self.min_step
+        )
 
-        return steps
+    def lockstep_params(self):
+        """Describe the detector for the fused threshold kernel."""
+        return {
+            "threshold": self.threshold,
+            "shift": 8,
+            "min_step": self.min_step,
+            "max_step": self.max_step,
+            "initial": -self.min_step,
+            "edge": False,
+        }
+
+    @classmethod
+    def get_cost(cls, params):
+        # Shift, compare, gap check, count and two gap checks
+        return {"ops": 11, "state": 8}
 
     @classmethod
     def get_param_grid(cls):
@@ -5,7 +5,8 @@ Copyright (c) 2025 Konrad Rieck. MIT License
 
 import numpy as np
 
-from .base import BaseDetector
+from .base import BaseDetector, crossings, signs, spaced_events, spaced_steps
+from .lockstep import UNBOUNDED
 
 
 class ThresholdEdge(BaseDetector):
@@ -15,25 +16,60 @@ class ThresholdEdge(BaseDetector):
         super().__init__(**params)
         self.threshold = threshold
         self.min_step = min_step
+        self.reset()
 
-    def detect_steps(self, x):
-        """Detect steps with edge detection."""
-        steps = 0
-        last_step = -self.min_step
-        above = False
+    def reset(self):
+        """Reset the stream."""
+        self.steps = 0
+        self.index = 0
+        self.last_step = -self.min_step
+        self.above = False
 
-        for i in range(0, len(x)):
-            if not above and x[i] > self.threshold:
+    def feed(self, chunk):
+        """Detect steps with edge detection in the next chunk."""
+        for value in np.asarray(chunk, dtype=float).tolist():
+            i = self.index
+            self.index += 1
+
+            if not self.above and value > self.threshold:
                 # Rising edge detected
-                if i - last_step >= self.min_step:
-                    steps += 1
-                    last_step = i
-                above = True
-            elif above and x[i] < self.threshold:
+                if i - self.last_step >= self.min_step:
+                    self.steps += 1
+                    self.last_step = i
+                self.above = True
+            elif self.above and value < self.threshold:
                 # Falling edge detected, reset flag
-                above = False
+                self.above = False
+
+    def preprocess(self, x):
+        """Convert the signal to an array once per recording."""
+        return np.asarray(x, dtype=float)
+
+    def detect_preprocessed(self, x):
+        """Detect steps by visiting only rising edges."""
+        rising, _ = crossings(signs(x, self.threshold))
+        return spaced_steps(rising, self.min_step, -self.min_step)
+
+    def events_preprocessed(self, x):
+        """Get indices of spaced rising edges."""
+        rising, _ = crossings(signs(x, self.threshold))
+        return spaced_events(rising, self.min_step, -self.min_step)
 
-        return steps
+    def lockstep_params(self):
+        """Describe the detector for the fused threshold kernel."""
+        return {
+            "threshold": self.threshold,
+            "shift": 0,
+            "min_step": self.min_step,
+            "max_step": UNBOUNDED,
+            "initial": -self.min_step,
+            "edge": True,
+        }
+
+    @classmethod
+    def get_cost(cls, params):
+        # Two compares, gap check and count; edge flag in one byte
+        return {"ops": 6, "state": 7}
 
     @classmethod
     def get_param_grid(cls):
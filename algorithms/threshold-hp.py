@@ -3,39 +3,64 @@
 Copyright (c) 2025 Konrad Rieck. MIT License
 """
 
-from collections import deque
-
 import numpy as np
 
-from .base import BaseDetector
+from .base import BaseDetector, count_above
+from .filters import MovingAverage, window_means
 
 
 class ThresholdHp(BaseDetector):
     """Threshold detector with high-pass filter."""
 
+    sweep_param = "threshold"
+    stage_params = ("win_size",)
+
     def __init__(self, threshold=100, win_size=100, **params):
         super().__init__(**params)
         self.threshold = threshold
         self.win_size = win_size
+        self.reset()
 
-    def detect_steps(self, x):
-        """Detect steps with high-pass filter."""
-        steps = 0
-        buffer = deque(maxlen=self.win_size)
+    def reset(self):
+        """Reset the stream."""
+        self.steps = 0
+        self.filter = MovingAverage(self.win_size)
 
-        for i in range(0, len(x)):
-            buffer.append(x[i])
-            if len(buffer) < self.win_size:
+    def feed(self, chunk):
+        """Detect steps with high-pass filter in the next chunk."""
+        for value in np.asarray(chunk, dtype=float).tolist():
+            mean_mag = self.filter.push(value)
+            if mean_mag is None:
                 continue
 
             # High-pass filter: remove static gravity component
-            mean_mag = sum(buffer) / self.win_size
-            hp_value = x[i] - mean_mag
+            hp_value = value - mean_mag
 
             if hp_value > self.threshold:
-                steps += 1
+                self.steps += 1
+
+    def preprocess(self, x):
+        """High-pass filter the signal once per window size."""
+        x = np.asarray(x, dtype=float)
+        return x[self.win_size - 1 :] - window_means(x, self.win_size)
+
+    def detect_preprocessed(self, hp_values):
+        """Detect steps on the high-pass filtered signal."""
+        return int(np.count_nonzero(hp_values > self.threshold))
 
-        return steps
+    def events_preprocessed(self, hp_values):
+        """Get indices of samples with high-pass filtered values above the threshold."""
+        return np.flatnonzero(hp_values > self.threshold) + self.win_size - 1
+
+    def sweep_steps(self, hp_values, thresholds):
+        """Detect steps on the high-pass filtered signal for all thresholds."""
+        return count_above(hp_values, thresholds)
+
+    @classmethod
+    def get_cost(cls, params):
+        # Update the running sum, divide, subtract, compare and count
+        win_size = params["win_size"]
+        return {"ops": 6, "state": 2 * win_size + 6}
 
     @classmethod
     def get_param_grid(cls):
@@ -3,46 +3,92 @@
 Copyright (c) 2025 Konrad Rieck. MIT License
 """
 
-from collections import deque
-
 import numpy as np
 
-from .base import BaseDetector
+from .base import BaseDetector, crossings, signs
+from .filters import MovingAverage, window_means
 
 
 class ThresholdHp8(BaseDetector):
     """Threshold detector with high-pass filter with edge detection (8-bit)."""
 
+    stage_params = ("win_size",)
+
     def __init__(self, threshold=100, win_size=100, max_dur=10, **params):
         super().__init__(**params)
         self.threshold = threshold
         self.win_size = win_size
         self.max_dur = max_dur
+        self.reset()
 
-    def detect_steps(self, x):
-        """Detect steps with high-pass filter."""
-        steps = 0
-        buffer = deque(maxlen=self.win_size)
-        above = 0
+    def reset(self):
+        """Reset the stream."""
+        self.steps = 0
+        self.index = 0
+        self.filter = MovingAverage(self.win_size)
+        self.above = 0
 
-        for i in range(0, len(x)):
-            mag = x[i] // 256
-            buffer.append(mag)
-            if len(buffer) < self.win_size:
+    def feed(self, chunk):
+        """Detect steps with high-pass filter in the next chunk."""
+        for value in np.asarray(chunk, dtype=float).tolist():
+            i = self.index
+            self.index += 1
+            mag = value // 256
+            mean_mag = self.filter.push(mag)
+            if mean_mag is None:
                 continue
 
             # High-pass filter: remove static gravity component
-            mean_mag = sum(buffer) / self.win_size
             hp_value = mag - mean_mag
 
-            if hp_value > self.threshold and above == 0:
-                above = i
-            elif hp_value < self.threshold and above > 0:
-                if i - above <= self.max_dur:
-                    steps += 1
-                above = 0
+            if hp_value > self.threshold and self.above == 0:
+                self.above = i
+            elif hp_value < self.threshold and self.above > 0:
+                if i - self.above <= self.max_dur:
+                    self.steps += 1
+                self.above = 0
+
+    def preprocess(self, x):
+        """High-pass filter the 8-bit signal once per window size."""
+        mag = np.asarray(x, dtype=float) // 256
+        return mag[self.win_size - 1 :] - window_means(mag, self.win_size)
+
+    def edges(self, hp_values):
+        """Get rising and falling edges of the high-pass filtered 8-bit signal."""
+        state = signs(hp_values, self.threshold)
+        rising, falling = crossings(state)
+
+        # Indices refer to the unfiltered signal as in detect_steps, where a
+        # rising edge at index 0 is indistinguishable from no edge
+        offset = self.win_size - 1
+        if offset == 0 and len(rising) > 0 and rising[0] == 0:
+            end = falling[0] if len(falling) > 0 else len(state)
+            later = np.flatnonzero(state[1:end] > 0)
+            if len(later) > 0:
+                rising[0] = later[0] + 1
+            else:
+                rising, falling = rising[1:], falling[1:]
 
-        return steps
+        return rising, falling
+
+    def detect_preprocessed(self, hp_values):
+        """Detect steps on the high-pass filtered 8-bit signal via its edges."""
+        # Edges alternate, so each falling edge closes the preceding rising one
+        rising, falling = self.edges(hp_values)
+        durations = falling - rising[: len(falling)]
+        return int(np.count_nonzero(durations <= self.max_dur))
+
+    def events_preprocessed(self, hp_values):
+        """Get indices of falling edges closing short pulses, counted as steps."""
+        rising, falling = self.edges(hp_values)
+        durations = falling - rising[: len(falling)]
+        return falling[durations <= self.max_dur] + self.win_size - 1
+
+    @classmethod
+    def get_cost(cls, params):
+        # Shift, update the running sum, divide, subtract and edge tracking
+        win_size = params["win_size"]
+        return {"ops": 10, "state": win_size + 8}
 
     @classmethod
     def get_param_grid(cls):
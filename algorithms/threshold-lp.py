@@ -3,37 +3,58 @@
 Copyright (c) 2025 Konrad Rieck. MIT License
 """
 
-from collections import deque
-
 import numpy as np
 
-from .base import BaseDetector
+from .base import BaseDetector, count_above
+from .filters import MovingAverage, window_means
 
 
 class ThresholdLp(BaseDetector):
     """Threshold detector with low-pass filter."""
 
+    sweep_param = "threshold"
+    stage_params = ("win_size",)
+
     def __init__(self, threshold=100, win_size=100, **params):
         super().__init__(**params)
         self.threshold = threshold
         self.win_size = win_size
+        self.reset()
 
-    def detect_steps(self, x):
-        """Detect steps with low-pass filter."""
-        steps = 0
-        buffer = deque(maxlen=self.win_size)
-
-        for i in range(0, len(x)):
-            buffer.append(x[i])
-            if len(buffer) < self.win_size:
-                continue
+    def reset(self):
+        """Reset the stream."""
+        self.steps = 0
+        self.filter = MovingAverage(self.win_size)
 
+    def feed(self, chunk):
+        """Detect steps with low-pass filter in the next chunk."""
+        for value in np.asarray(chunk, dtype=float).tolist():
             # Low-pass filter: remove high-frequency noise
-            lp_value = sum(buffer) / self.win_size
-            if lp_value > self.threshold:
-                steps += 1
+            lp_value = self.filter.push(value)
+            if lp_value is not None and lp_value > self.threshold:
+                self.steps += 1
+
+    def preprocess(self, x):
+        """Low-pass filter the signal once per window size."""
+        return window_means(x, self.win_size)
 
-        return steps
+    def detect_preprocessed(self, lp_values):
+        """Detect steps on the low-pass filtered signal."""
+        return int(np.count_nonzero(lp_values > self.threshold))
+
+    def events_preprocessed(self, lp_values):
+        """Get indices of samples with low-pass filtered values above the threshold."""
+        return np.flatnonzero(lp_values > self.threshold) + self.win_size - 1
+
+    def sweep_steps(self, lp_values, thresholds):
+        """Detect steps on the low-pass filtered signal for all thresholds."""
+        return count_above(lp_values, thresholds)
+
+    @classmethod
+    def get_cost(cls, params):
+        # Update the running sum, divide, compare and count
+        win_size = params["win_size"]
+        return {"ops": 5, "state": 2 * win_size + 6}
 
     @classmethod
     def get_param_grid(cls):
@@ -5,7 +5,8 @@ Copyright (c) 2025 Konrad Rieck. MIT License
 
 import numpy as np
 
-from .base import BaseDetector
+from .base import BaseDetector, spaced_events, spaced_steps
+from .lockstep import UNBOUNDED
 
 
 class ThresholdMin(BaseDetector):
@@ -15,23 +16,58 @@ class ThresholdMin(BaseDetector):
         super().__init__(**params)
         self.threshold = threshold
         self.min_step = min_step
+        self.reset()
 
-    def detect_steps(self, x):
-        """Detect steps with minimum step size."""
-        steps = 0
-        last_step = -self.min_step
+    def reset(self):
+        """Reset the stream."""
+        self.steps = 0
+        self.index = 0
+        self.last_step = -self.min_step
+
+    def feed(self, chunk):
+        """Detect steps with minimum step size in the next chunk."""
+        for value in np.asarray(chunk, dtype=float).tolist():
+            i = self.index
+            self.index += 1
 
-        for i in range(0, len(x)):
             # Skip if step is too small
-            if i - last_step < self.min_step:
+            if i - self.last_step < self.min_step:
                 continue
 
             # Check for transition
-            if x[i] > self.threshold:
-                steps += 1
-                last_step = i
+            if value > self.threshold:
+                self.steps += 1
+                self.last_step = i
+
+    def preprocess(self, x):
+        """Convert the signal to an array once per recording."""
+        return np.asarray(x, dtype=float)
+
+    def detect_preprocessed(self, x):
+        """Detect steps by visiting only samples above the threshold."""
+        events = np.flatnonzero(x > self.threshold)
+        return spaced_steps(events, self.min_step, -self.min_step)
+
+    def events_preprocessed(self, x):
+        """Get indices of spaced samples above the threshold."""
+        events = np.flatnonzero(x > self.threshold)
+        return spaced_events(events, self.min_step, -self.min_step)
 
-        return steps
+    def lockstep_params(self):
+        """Describe the detector for the fused threshold kernel."""
+        return {
+            "threshold": self.threshold,
+            "shift": 0,
+            "min_step": self.min_step,
+            "max_step": UNBOUNDED,
+            "initial": -self.min_step,
+            "edge": False,
+        }
+
+    @classmethod
+    def get_cost(cls, params):
+        # Gap check, compare and count
+        return {"ops": 5, "state": 6}
 
     @classmethod
     def get_param_grid(cls):
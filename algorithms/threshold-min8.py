@@ -5,7 +5,8 @@ Copyright (c) 2025 Konrad Rieck. MIT License
 
 import numpy as np
 
-from .base import BaseDetector
+from .base import BaseDetector, spaced_events, spaced_steps
+from .lockstep import UNBOUNDED
 
 
 class ThresholdMin8(BaseDetector):
@@ -15,25 +16,59 @@ class ThresholdMin8(BaseDetector):
         super().__init__(**params)
         self.threshold = threshold
         self.min_step = min_step
+        self.reset()
 
-    def detect_steps(self, x):
-        """Detect steps with minimum step size."""
-        steps = 0
-        last_step = -self.min_step
+    def reset(self):
+        """Reset the stream."""
+        self.steps = 0
+        self.index = 0
+        self.last_step = -self.min_step
 
-        for i in range(0, len(x)):
-            mag = x[i] // 256
+    def feed(self, chunk):
+        """Detect steps with minimum step size in the next chunk."""
+        for value in np.asarray(chunk, dtype=float).tolist():
+            i = self.index
+            self.index += 1
+            mag = value // 256
 
             # Skip if step is too small
-            if i - last_step < self.min_step:
+            if i - self.last_step < self.min_step:
                 continue
 
             # Check for transition
             if mag > self.threshold:
-                steps += 1
-                last_step = i
+                self.steps += 1
+                self.last_step = i
 
-        return steps
+    def preprocess(self, x):
+        """Reduce the signal to 8 bits once per recording."""
+        return np.asarray(x, dtype=float) // 256
+
+    def detect_preprocessed(self, mag):
+        """Detect steps by visiting only samples above the threshold."""
+        events = np.flatnonzero(mag > self.threshold)
+        return spaced_steps(events, self.min_step, -self.min_step)
+
+    def events_preprocessed(self, mag):
+        """Get indices of spaced samples above the threshold."""
+        events = np.flatnonzero(mag > self.threshold)
+        return spaced_events(events, self.min_step, -self.min_step)
+
+    def lockstep_params(self):
+        """Describe the detector for the fused threshold kernel."""
+        return {
+            "threshold": self.threshold,
+            "shift": 8,
+            "min_step": self.min_step,
+            "max_step": UNBOUNDED,
+            "initial": -self.min_step,
+            "edge": False,
+        }
+
+    @classmethod
+    def get_cost(cls, params):
+        # Shift, gap check, compare and count
+        return {"ops": 6, "state": 6}
 
     @classmethod
     def get_param_grid(cls):
@@ -5,24 +5,61 @@ Copyright (c) 2025 Konrad Rieck. MIT License
 
 import numpy as np
 
-from .base import BaseDetector
+from .base import BaseDetector, count_above
+from .lockstep import UNBOUNDED
 
 
 class Threshold(BaseDetector):
     """Static threshold detector that counts steps above a magnitude threshold."""
 
+    sweep_param = "threshold"
+
     def __init__(self, threshold=100, **params):
         super().__init__(**params)
         self.threshold = threshold
+        self.reset()
+
+    def reset(self):
+        """Reset the stream."""
+        self.steps = 0
+
+    def feed(self, chunk):
+        """Detect steps above a magnitude threshold in the next chunk."""
+        for value in np.asarray(chunk, dtype=float).tolist():
+            if value > self.threshold:
+                self.steps += 1
+
+    def sweep_steps(self, x, thresholds):
+        """Detect steps above all thresholds in one pass."""
+        return count_above(x, thresholds)
+
+    def preprocess(self, x):
+        """Convert the signal to an array once per recording."""
+        return np.asarray(x, dtype=float)
 
-    def detect_steps(self, x):
-        """Detect steps above a magnitude threshold."""
-        steps = 0
-        for i in range(0, len(x)):
-            if x[i] > self.threshold:
-                steps += 1
+    def detect_preprocessed(self, x):
+        """Detect steps above a magnitude threshold without a loop."""
+        return int(np.count_nonzero(x > self.threshold))
 
-        return steps
+    def events_preprocessed(self, x):
+        """Get indices of samples above the threshold."""
+        return np.flatnonzero(np.asarray(x, dtype=float) > self.threshold)
+
+    def lockstep_params(self):
+        """Describe the detector for the fused threshold kernel."""
+        return {
+            "threshold": self.threshold,
+            "shift": 0,
+            "min_step": 0,
+            "max_step": UNBOUNDED,
+            "initial": 0,
+            "edge": False,
+        }
+
+    @classmethod
+    def get_cost(cls, params):
+        # Compare and count
+        return {"ops": 2, "state": 2}
 
     @classmethod
     def get_param_grid(cls):
@@ -0,0 +1,219 @@
+#!/usr/bin/env python3
+"""
+Benchmark Step Detection
+
+This script times all step detection algorithms on standard recordings,
+using the streaming reference in detect_steps (python), the fast path in
+count_steps (fast) and C bindings in native_steps (native) if available.
+It reports samples per second and peak memory, stores the results in a
+JSON file keyed by git commit, and fails if a path got slower or needs
+more memory than a baseline commit beyond a threshold.
+
+Copyright (c) 2025 Konrad Rieck. MIT License
+"""
+
+import argparse
+import json
+import subprocess
+import sys
+import time
+import tracemalloc
+from pathlib import Path
+
+import numpy as np
+
+from algorithms.registry import detectors
+from calibrate import load_data, load_results
+
+# Seconds a timed run lasts at least, passing over the recordings repeatedly
+MIN_RUN_TIME = 0.2
+
+
+def parse_args():
+    # Parse command line arguments
+    parser = argparse.ArgumentParser(description="Benchmark step detection")
+    parser.add_argument(
+        "-d",
+        "--data-dir",
+        type=Path,
+        metavar="<dir>",
+        default=Path("recordings/l2-25hz-bw4"),
+        help="Directory with recordings (default: recordings/l2-25hz-bw4)",
+    )
+    parser.add_argument(
+        "-n",
+        "--repeat",
+        type=int,
+        default=5,
+        help="Timed runs per path, the fastest counts (default: 5)",
+    )
+    parser.add_argument(
+        "-o",
+        "--output",
+        type=Path,
+        metavar="<file>",
+        default=Path("runtime/bench.json"),
+        help="JSON file with results keyed by commit (default: runtime/bench.json)",
+    )
+    parser.add_argument(
+        "--baseline",
+        type=str,
+        metavar="<commit>",
+        default=None,
+        help="Commit to compare against (default: latest other commit in file)",
+    )
+    parser.add_argument(
+        "--threshold",
+        type=float,
+        default=0.25,
+        help="Relative slowdown or memory growth flagged (default: 0.25)",
+    )
+    parser.add_argument(
+        "algorithms",
+        type=str,
+        nargs="*",
+        metavar="<algo>",
+        help=f"Algorithms to benchmark (default: all). Available: {list(detectors)}",
+    )
+
+    args = parser.parse_args()
+    if not args.algorithms:
+        args.algorithms = list(detectors)
+
+    return args
+
+
+def get_commit():
+    """Get the current commit, marked dirty if algorithms have changes"""
+    commit = subprocess.run(
+        ["git", "rev-parse", "--short", "HEAD"], capture_output=True, text=True
+    ).stdout.strip()
+    status = subprocess.run(
+        ["git", "status", "--porcelain", "algorithms"], capture_output=True, text=True
+    ).stdout.strip()
+    return f"{commit}-dirty" if status else commit
+
+
+def get_paths(detector):
+    """Get step counting paths of a detector, skipping missing C bindings"""
+    paths = {"python": detector.detect_steps, "fast": detector.count_steps}
+    try:
+        detector.native_steps(np.zeros(1))
+        paths["native"] = detector.native_steps
+    except NotImplementedError:
+        pass
+    return paths
+
+
+def time_passes(count, data, passes):
+    """Time passes of a path over all recordings in CPU time of the process"""
+    # CPU time excludes time taken by other processes on a busy machine
+    start = time.process_time()
+    for _ in range(passes):
+        for mag_series in data:
+            count(mag_series)
+    return time.process_time() - start
+
+
+def bench_path(count, data, repeat):
+    """Time a path on all recordings and measure its peak memory"""
+    # Fast paths need several passes per run to be timed reliably
+    passes = 1
+    while (elapsed := time_passes(count, data, passes)) < MIN_RUN_TIME:
+        passes = max(2 * passes, int(passes * MIN_RUN_TIME / max(elapsed, 1e-6)))
+    times = [elapsed / passes]
+    times += [time_passes(count, data, passes) / passes for _ in range(repeat - 1)]
+
+    # Memory is traced in a separate run, as tracing slows down Python code
+    tracemalloc.start()
+    for mag_series in data:
+        count(mag_series)
+    _, peak = tracemalloc.get_traced_memory()
+    tracemalloc.stop()
+
+    samples = sum(len(mag_series) for mag_series in data)
+    return {"samples_per_sec": samples / min(times), "peak_kib": peak / 1024}
+
+
+def get_baseline(runs, commit, baseline):
+    """Get the baseline run, by default the latest run of another commit"""
+    if baseline is not None:
+        return baseline, runs[baseline]
+    others = [c for c in runs if c != commit]
+    if not others:
+        return None, None
+    latest = max(others, key=lambda c: runs[c]["date"])
+    return latest, runs[latest]
+
+
+def find_regressions(results, base, threshold):
+    """Compare results with a baseline and list paths beyond the threshold"""
+    regressions = []
+    for algo_name, paths in results.items():
+        for path, result in paths.items():
+            old = base.get(algo_name, {}).get(path)
+            if old is None:
+                continue
+            speed = result["samples_per_sec"] / old["samples_per_sec"]
+            memory = result["peak_kib"] / max(old["peak_kib"], 1e-9)
+            if speed < 1 - threshold:
+                regressions.append((algo_name, path, "speed", speed))
+            if memory > 1 + threshold:
+                regressions.append((algo_name, path, "memory", memory))
+    return regressions
+
+
+def main():
+    """Main function"""
+    args = parse_args()
+
+    # An explicit baseline must exist, only a first commit has none
+    runs = json.loads(args.output.read_text()) if args.output.exists() else {}
+    if args.baseline is not None and args.baseline not in runs:
+        raise ValueError(f"No baseline {args.baseline} in {args.output}")
+
+    # Detectors run with the best parameters of previous calibrations
+    set1_data, set2_data = load_data(args.data_dir)
+    data = [np.asarray(mag_series) for mag_series, _, _ in set1_data + set2_data]
+    stored = load_results(args.data_dir.parent / f"{args.data_dir.name}.yml")
+
+    results = {}
+    for algo_name in args.algorithms:
+        params = stored.get(algo_name, {}).get("best_param", [{}])[0]
+        detector = detectors[algo_name](**params)
+        results[algo_name] = {}
+        for path, count in get_paths(detector).items():
+            result = bench_path(count, data, args.repeat)
+            results[algo_name][path] = result
+            print(
+                f"{algo_name}: {path} {result['samples_per_sec']:,.0f} samples/s, "
+                f"{result['peak_kib']:.1f} KiB"
+            )
+
+    commit = get_commit()
+    base_commit, base = get_baseline(runs, commit, args.baseline)
+
+    # Keep the results of other algorithms from earlier runs of this commit
+    run = runs.setdefault(commit, {"results": {}})
+    run["date"] = time.strftime("%Y-%m-%dT%H:%M:%S")
+    run["data_dir"] = str(args.data_dir)
+    run["results"].update(results)
+    args.output.write_text(json.dumps(runs, indent=2) + "\n")
+
+    if base is None:
+        print(f"# commit: {commit}, no baseline in {args.output}")
+        return
+
+    regressions = find_regressions(results, base["results"], args.threshold)
+    for algo_name, path, metric, ratio in regressions:
+        print(
+            f"  REGRESSION {algo_name} {path}: {metric} {ratio:.2f}x of {base_commit}"
+        )
+    print(
+        f"# commit: {commit}, baseline: {base_commit}, regressions: {len(regressions)}"
+    )
+    sys.exit(1 if regressions else 0)
+
+
+if __name__ == "__main__":
+    main()
@@ -9,17 +9,55 @@ Copyright (c) 2025 Konrad Rieck. MIT License
 """
 
 import argparse
+import ast
+import cProfile
+import hashlib
+import heapq
+import inspect
 import json
+import math
+import multiprocessing.util
+import os
+import pickle
 import random
-from concurrent.futures import ProcessPoolExecutor, as_completed
+import re
+import socket
+import sqlite3
+import time
+from collections import OrderedDict, deque
+from concurrent.futures import FIRST_COMPLETED, ProcessPoolExecutor, wait
 from pathlib import Path
 
 import numpy as np
 import pandas as pd
-from sklearn.model_selection import ParameterGrid
 from tqdm import tqdm
 
+from algorithms.filters import centered_means
+from algorithms.lockstep import Lockstep
 from algorithms.registry import detectors
+from farm import FarmExecutor
+
+# Fraction of evaluated points regarded as good by the Parzen estimator
+TPE_GAMMA = 0.15
+
+# Number of candidates drawn per proposed point by the Parzen estimator
+TPE_CANDIDATES = 24
+
+# Upper edges of the task latency histogram in milliseconds
+LATENCY_BINS = [2**k for k in range(18)]
+
+# Seconds of smoothing and minimum spacing of foot strikes in a recording
+STRIKE_SMOOTH = 0.04
+STRIKE_SPACING = 0.25
+
+# Maximum number of preprocessing stages cached per worker
+STAGE_CACHE_SIZE = 512
+
+# Cache of preprocessing stages in each worker process
+stage_cache = OrderedDict()
+
+# Calibration data broadcast once to each worker process
+worker_data = None
 
 
 def convert_numpy_types(obj):
@@ -45,9 +83,11 @@ def parse_args():
         "-d",
         "--data-dir",
         type=Path,
+        action="append",
         metavar="<dir>",
-        default=Path("recordings/l2-12hz"),
-        help="Directory with recordings (default: recordings/l2-12hz)",
+        default=None,
+        help="Directory with recordings, repeat to calibrate several in one run "
+        "(default: recordings/l2-12hz)",
     )
     parser.add_argument(
         "-c",
@@ -56,6 +96,103 @@ def parse_args():
         default=20000,
         help="Maximum number of combinations (default: 20000)",
     )
+    parser.add_argument(
+        "-b",
+        "--batch-size",
+        type=int,
+        default=250,
+        help="Parameter combinations per worker task (default: 250)",
+    )
+    parser.add_argument(
+        "-s",
+        "--search",
+        choices=["grid", "halving", "tpe", "incremental", "refine"],
+        default="grid",
+        help="Search strategy: grid, halving, tpe, incremental or refine "
+        "(default: grid)",
+    )
+    parser.add_argument(
+        "--budget",
+        type=int,
+        default=2000,
+        help="Number of evaluations for tpe and refine search (default: 2000)",
+    )
+    parser.add_argument(
+        "-r",
+        "--results",
+        type=Path,
+        metavar="<file>",
+        default=None,
+        help="Results seeding and updated by refine search "
+        "(default: <data-dir>.yml)",
+    )
+    parser.add_argument(
+        "--cache",
+        type=Path,
+        metavar="<file>",
+        default=None,
+        help="SQLite file caching evaluations across runs (default: none)",
+    )
+    parser.add_argument(
+        "--seed",
+        type=int,
+        default=None,
+        help="Seed for sampling of parameters (default: none)",
+    )
+    parser.add_argument(
+        "--cv",
+        type=str,
+        metavar="<scheme>",
+        default="split",
+        help="Cross-validation: split, kfold:<k> or loao (default: split)",
+    )
+    parser.add_argument(
+        "-j",
+        "--workers",
+        type=int,
+        default=os.cpu_count() or 1,
+        help="Number of worker processes (default: number of cores)",
+    )
+    parser.add_argument(
+        "--farm",
+        type=str,
+        metavar="<address>",
+        default=None,
+        help="Serve workers of farm.py at host:port (default host: 127.0.0.1) "
+        "or a Unix socket path, authenticated by FARM_KEY",
+    )
+    parser.add_argument(
+        "-k",
+        "--top-k",
+        type=int,
+        default=1,
+        help="Number of best parameters ranked per fold (default: 1)",
+    )
+    parser.add_argument(
+        "--pareto",
+        action="store_true",
+        help="Print Pareto front of error, operations and state per fold",
+    )
+    parser.add_argument(
+        "--stats",
+        type=Path,
+        metavar="<file>",
+        default=None,
+        help="JSON file for throughput and latency statistics (default: none)",
+    )
+    parser.add_argument(
+        "--profile",
+        type=Path,
+        metavar="<dir>",
+        default=None,
+        help="Directory for cProfile dumps of each worker (default: none)",
+    )
+    parser.add_argument(
+        "--eta",
+        type=int,
+        default=3,
+        help="Reduction factor per round of successive halving (default: 3)",
+    )
     parser.add_argument(
         "algorithms",
         type=str,
@@ -67,8 +204,32 @@ def parse_args():
     args = parser.parse_args()
 
     # Check for valid data directory with split.json
-    if not (args.data_dir / "split.json").exists():
-        raise FileNotFoundError(f"No valid data directory: {args.data_dir}")
+    args.data_dir = args.data_dir or [Path("recordings/l2-12hz")]
+    for data_dir in args.data_dir:
+        if not (data_dir / "split.json").exists():
+            raise FileNotFoundError(f"No valid data directory: {data_dir}")
+    if len({data_dir.resolve() for data_dir in args.data_dir}) < len(args.data_dir):
+        raise ValueError("Data directories must be given only once")
+
+    # Check for results file of a single data directory
+    if args.results and len(args.data_dir) > 1:
+        raise ValueError("Results file requires a single data directory")
+
+    # Check for valid cross-validation scheme
+    if args.cv not in ("split", "loao") and not re.fullmatch(r"kfold:\d+", args.cv):
+        raise ValueError(f"Invalid cross-validation scheme: {args.cv}")
+
+    # Check for valid shortlist size
+    if args.top_k < 1:
+        raise ValueError("Shortlist must contain at least one parameter set")
+
+    # Check for profile directory
+    if args.profile:
+        args.profile.mkdir(parents=True, exist_ok=True)
+
+    # Check for cache in incremental mode
+    if args.search == "incremental" and not args.cache:
+        raise ValueError("Incremental search requires a cache file")
 
     # Check for valid algorithms
     if "all" in args.algorithms:
@@ -101,22 +262,69 @@ def load_data(data_dir):
     return set1_data, set2_data
 
 
-def get_param_grid(algo_name, max_combi):
-    """Get parameter grid for the specified algorithm"""
-    detector_class = detectors[algo_name]
-    param_grid = detector_class.get_param_grid()
+def load_results(path):
+    """Load results of previous runs by algorithm"""
+    results = {}
+    if not path.exists():
+        return results
+
+    entry = None
+    for line in path.read_text().splitlines():
+        match = re.match(r"^-?\s*(\w+):\s*(.*)$", line)
+        if not match:
+            continue
+        key, value = match.groups()
+        if key == "algorithm":
+            entry = results[value] = {}
+        elif entry is not None and key == "best_param":
+            entry[key] = ast.literal_eval(value)
+        elif entry is not None:
+            entry[key] = float(value)
+
+    return results
+
+
+def save_results(path, results):
+    """Save results by algorithm in the format of load_results"""
+    lines = []
+    for algorithm, entry in results.items():
+        lines.append(f"- algorithm: {algorithm}")
+        lines.append(f"  best_param: {entry['best_param']}")
+        lines.append(f"  calib_error: {entry['calib_error']:.2f}")
+        lines.append(f"  eval_error: {entry['eval_error']:.2f}")
+    path.write_text("\n".join(lines) + "\n")
+
+
+def get_axes(algo_name):
+    """Get parameter axes of the specified algorithm in sorted order"""
+    param_grid = detectors[algo_name].get_param_grid()
+    return {
+        name: convert_numpy_types(list(values))
+        for name, values in sorted(param_grid.items())
+    }
 
-    # Convert numpy types to native Python types
-    converted_grid = []
-    for params in ParameterGrid(param_grid):
-        converted_params = convert_numpy_types(params)
-        converted_grid.append(converted_params)
 
-    # Limit grid
-    if len(converted_grid) > max_combi:
-        converted_grid = random.sample(converted_grid, max_combi)
+def decode_index(axes, index):
+    """Decode flat grid index into parameters, with the last axis fastest"""
+    params = {}
+    for name, values in reversed(axes.items()):
+        index, i = divmod(index, len(values))
+        params[name] = values[i]
 
-    return converted_grid
+    return dict(sorted(params.items()))
+
+
+def get_param_grid(algo_name, max_combi, seed=None):
+    """Get parameter grid for the specified algorithm"""
+    axes = get_axes(algo_name)
+    n_combi = math.prod(len(values) for values in axes.values())
+
+    # Limit grid by sampling flat indices without materializing the product
+    indices = range(n_combi)
+    if n_combi > max_combi:
+        indices = sorted(random.Random(seed).sample(indices, max_combi))
+
+    return [decode_index(axes, i) for i in indices]
 
 
 def eval_algo(algo_name, data, params):
@@ -126,7 +334,7 @@ def eval_algo(algo_name, data, params):
 
     runs = []
     for mag_series, true_steps, fname in data:
-        steps = detector.detect_steps(mag_series)
+        steps = detector.count_steps(mag_series)
         runs.append(
             {
                 "data": fname,
@@ -136,15 +344,16 @@ def eval_algo(algo_name, data, params):
             }
         )
 
-    walking_error = float(
-        np.mean([run["error"] for run in runs if "walking" in run["data"]])
-    )
-    non_walking_error = float(
-        np.mean([run["error"] for run in runs if "walking" not in run["data"]])
-    )
+    walking = [run["error"] for run in runs if "walking" in run["data"]]
+    non_walking = [run["error"] for run in runs if "walking" not in run["data"]]
+    walking_error = float(np.mean(walking)) if walking else np.nan
+    non_walking_error = float(np.mean(non_walking)) if non_walking else np.nan
+
+    # Held-out folds may lack walking or non-walking recordings
+    groups = [e for e in (walking_error, non_walking_error) if not np.isnan(e)]
 
     return {
-        "error_mean": (walking_error + non_walking_error) / 2,
+        "error_mean": float(np.mean(groups)),
         "walking_error": walking_error,
         "non_walking_error": non_walking_error,
         "runs": runs,
@@ -152,67 +361,1178 @@ def eval_algo(algo_name, data, params):
     }
 
 
-def calibrate_algorithm(algorithm, calib_data, max_combi):
-    """Calibrate algorithm parameters using grid search and parallel evaluation"""
-    param_grid = get_param_grid(algorithm, max_combi)
-    best_params = None
-    best_error = float("inf")
+def get_sample_rate(data_dir):
+    """Estimate the sampling rate of a dataset from timestamps of a recording"""
+    split = json.load(open(data_dir / "split.json", "r"))
+    stamps = pd.read_csv(data_dir / split["set1"][0], usecols=["Timestamp"])
+    return 1.0 / float(np.median(np.diff(stamps["Timestamp"])))
+
+
+def get_strikes(mag_series, rate):
+    """Estimate foot strikes of a recording independent of any detector"""
+    # Steps are local maxima of the smoothed magnitude above its mean at a
+    # minimum spacing, and their strikes start at the minimum before them
+    x = centered_means(mag_series, round(STRIKE_SMOOTH * rate))
+    win = max(1, round(STRIKE_SPACING * rate))
+    padded = np.pad(x, win, constant_values=-np.inf)
+    windows = np.lib.stride_tricks.sliding_window_view(padded, 2 * win + 1)
+    peaks = np.flatnonzero((np.argmax(windows, axis=1) == win) & (x > x.mean()))
+    starts = np.maximum(peaks - win, np.concatenate(([0], peaks[:-1])))
+    return np.array(
+        [start + np.argmin(x[start : peak + 1]) for start, peak in zip(starts, peaks)],
+        dtype=int,
+    )
+
+
+def get_delays(detector, mag_series, strikes, rate):
+    """Delays in seconds from foot strikes to detected steps and unmatched steps"""
+    # Steps match the latest strike at or before the sample causing them,
+    # unless there is none or an earlier step matched it already
+    events = detector.detect_events(np.asarray(mag_series, dtype=float))
+    causes = np.maximum(events - detector.get_lookahead(), 0)
+    matches = np.searchsorted(strikes, causes, side="right") - 1
+    first = np.diff(matches, prepend=-1) > 0
+    valid = (matches >= 0) & first
+    delays = (events[valid] - strikes[matches[valid]]) / rate
+    return delays, int(np.count_nonzero(~valid))
+
+
+def delay_stats(delays):
+    """Summarize the distribution of detection delays in milliseconds"""
+    if len(delays) == 0:
+        return None
+    ms = np.asarray(delays) * 1000
+    p10, median, p90 = np.percentile(ms, [10, 50, 90])
+    stats = {
+        "p10": p10,
+        "median": median,
+        "p90": p90,
+        "max": ms.max(),
+        "jitter": ms.std(),
+    }
+    return {key: round(float(value), 1) for key, value in stats.items()}
+
+
+def get_stage(algo_name, detector, params, mag_series, recording):
+    """Get the preprocessing stage of a detector from the LRU cache"""
+    stage_params = detectors[algo_name].stage_params
+
+    # File names repeat across datasets, so recordings are keyed by index
+    key = (algo_name, recording, tuple(params[p] for p in stage_params))
+    if key in stage_cache:
+        stage_cache.move_to_end(key)
+        return stage_cache[key]
+
+    signal = detector.preprocess(mag_series)
+    stage_cache[key] = signal
+    if len(stage_cache) > STAGE_CACHE_SIZE:
+        stage_cache.popitem(last=False)
+
+    return signal
+
+
+def init_worker(data, profile_dir=None):
+    """Receive the calibration data once per worker process"""
+    global worker_data
+    worker_data = data
+    stage_cache.clear()
+
+    # Profile the worker until it exits, readable with pstats or snakeviz
+    if profile_dir:
+        profiler = cProfile.Profile()
+        path = profile_dir / f"worker-{os.getpid()}.prof"
+        multiprocessing.util.Finalize(
+            None, dump_profile, args=(profiler, path), exitpriority=10
+        )
+        profiler.enable()
+
+
+def dump_profile(profiler, path):
+    """Stop profiler and write its statistics"""
+    profiler.disable()
+    profiler.dump_stats(path)
+
+
+def eval_algo_batch(algo_name, param_batch, recordings):
+    """Evaluate the algorithm on worker recordings for a batch of parameters"""
+    start = time.perf_counter()
+    detector_class = detectors[algo_name]
+    data = [worker_data[j] for j in recordings]
+    predicted = np.zeros((len(param_batch), len(data)), dtype=np.int32)
+    stage_time = 0.0
+
+    # Threshold detectors run in lockstep over one pass of each recording
+    if is_fused(algo_name):
+        kernel = Lockstep([detector_class(**params) for params in param_batch])
+        for j, (mag_series, _, _) in enumerate(data):
+            predicted[:, j] = kernel.run(mag_series)
+        sweeps = []
+    else:
+        sweeps = get_sweeps(algo_name, param_batch)
+
+    for params, values, rows in sweeps:
+        detector = detector_class(**params)
+        for j, (mag_series, _, _) in enumerate(data):
+            stage_start = time.perf_counter()
+            signal = get_stage(algo_name, detector, params, mag_series, recordings[j])
+            stage_time += time.perf_counter() - stage_start
+            if values is None:
+                predicted[rows, j] = detector.detect_preprocessed(signal)
+            else:
+                predicted[rows, j] = detector.sweep_steps(signal, values)
+
+    # Return step counts only (batch x recordings) and timing of the worker
+    timing = {
+        "worker": f"{socket.gethostname()}:{os.getpid()}",
+        "start": start,
+        "end": time.perf_counter(),
+        "stage_time": stage_time,
+    }
+    return predicted, timing
+
+
+def error_means(errors, data):
+    """Balanced mean error of walking and non-walking recordings per row"""
+    walking = np.array(["walking" in fname for _, _, fname in data])
+    # Folds may lack walking or non-walking recordings
+    groups = [mask for mask in (walking, ~walking) if mask.any()]
+    return sum(errors[:, mask].mean(axis=1) for mask in groups) / len(groups)
+
+
+def is_fused(algo_name):
+    """Check whether batches of the algorithm run in the lockstep kernel"""
+    # Sweeps over the threshold are faster than lockstep detectors
+    detector_class = detectors[algo_name]
+    if detector_class.sweep_param:
+        return False
+    return detector_class().lockstep_params() is not None
+
+
+def get_sweeps(algo_name, param_grid):
+    """Group parameter grid into sweeps over the sweep parameter"""
+    sweep_param = detectors[algo_name].sweep_param
+    if not sweep_param:
+        return [(params, None, [i]) for i, params in enumerate(param_grid)]
+
+    sweeps = {}
+    for i, params in enumerate(param_grid):
+        fixed = {k: v for k, v in params.items() if k != sweep_param}
+        key = tuple(sorted(fixed.items()))
+        sweep = sweeps.setdefault(key, (fixed, [], []))
+        sweep[1].append(params[sweep_param])
+        sweep[2].append(i)
+
+    return list(sweeps.values())
 
-    # Parallel evaluation with progress bar
-    with ProcessPoolExecutor() as executor:
-        # Submit all parameter combinations for evaluation
-        future_to_params = {
-            executor.submit(eval_algo, algorithm, calib_data, params): params
-            for params in param_grid
+
+def get_batches(algo_name, param_grid, batch_size):
+    """Split parameter grid into batches of indices sharing preprocessing stages"""
+    stage_params = detectors[algo_name].stage_params
+
+    # Order grid so that combinations sharing a stage are adjacent, and fused
+    # batches with close thresholds visit few samples of each recording
+    first = ("threshold",) if is_fused(algo_name) else stage_params
+    order = sorted(
+        range(len(param_grid)),
+        key=lambda i: (
+            [param_grid[i][p] for p in first],
+            sorted(param_grid[i].items()),
+        ),
+    )
+
+    return [order[i : i + batch_size] for i in range(0, len(order), batch_size)]
+
+
+class EvalCache:
+    """Persistent cache of step counts per detector, parameters and recording"""
+
+    def __init__(self, path):
+        self.db = sqlite3.connect(path)
+        self.db.execute(
+            "CREATE TABLE IF NOT EXISTS evals (detector TEXT, params TEXT, "
+            "recording TEXT, predicted INTEGER, "
+            "PRIMARY KEY (detector, params, recording))"
+        )
+        self.db.execute(
+            "CREATE INDEX IF NOT EXISTS evals_recording ON evals (detector, recording)"
+        )
+        self.detector_keys = {}
+
+    def detector_key(self, algo_name):
+        """Key of a detector given by the hash of its source files"""
+        if algo_name not in self.detector_keys:
+            # Modules without detectors, such as filters and the lockstep
+            # kernel, are on the evaluation path of every detector
+            own = {Path(inspect.getsourcefile(cls)) for cls in detectors.values()}
+            shared = set(Path(inspect.getsourcefile(Lockstep)).parent.glob("*.py"))
+            paths = [
+                Path(inspect.getsourcefile(cls))
+                for cls in detectors[algo_name].__mro__[:-1]
+            ]
+            paths += sorted(shared - own)
+
+            sha = hashlib.sha256()
+            for path in paths:
+                sha.update(path.read_bytes())
+            self.detector_keys[algo_name] = f"{algo_name}:{sha.hexdigest()}"
+        return self.detector_keys[algo_name]
+
+    @staticmethod
+    def params_key(params):
+        """Key of a parameter combination"""
+        return json.dumps(params, sort_keys=True)
+
+    @staticmethod
+    def recording_key(recording):
+        """Key of a recording given by the hash of its content"""
+        mag_series, true_steps, _ = recording
+        sha = hashlib.sha256(mag_series.to_numpy().tobytes())
+        sha.update(str(true_steps).encode())
+        return sha.hexdigest()
+
+    def cached_params(self, algo_name, data):
+        """Get parameters complete on the cached recordings in insertion order"""
+        # Recordings calibrated before, parameters that halving dropped or tpe
+        # tried on some recordings only are left out
+        detector_key = self.detector_key(algo_name)
+        self.keys_table("lookup_recordings", map(self.recording_key, data))
+        ((n_old,),) = self.db.execute(
+            "SELECT COUNT(*) FROM lookup_recordings WHERE EXISTS (SELECT 1 "
+            "FROM evals WHERE detector = ? AND recording = lookup_recordings.key)",
+            (detector_key,),
+        )
+        rows = self.db.execute(
+            "SELECT params FROM evals JOIN lookup_recordings "
+            "ON recording = lookup_recordings.key WHERE detector = ? "
+            "GROUP BY params HAVING COUNT(DISTINCT recording) = ? "
+            "ORDER BY MIN(evals.rowid)",
+            (detector_key, n_old),
+        )
+        return [json.loads(params) for (params,) in rows]
+
+    def keys_table(self, name, keys):
+        """Fill a temporary table with keys to join the evaluations with"""
+        self.db.execute(
+            f"CREATE TEMP TABLE IF NOT EXISTS {name} (key TEXT PRIMARY KEY)"
+        )
+        self.db.execute(f"DELETE FROM {name}")
+        self.db.executemany(
+            f"INSERT OR IGNORE INTO {name} VALUES (?)", [(key,) for key in keys]
+        )
+
+    def lookup(self, algo_name, param_grid, data):
+        """Get cached step counts and mask of missing entries"""
+        # Only the requested parameters are read, through the index of the
+        # primary key on (detector, params, recording)
+        self.keys_table("lookup_params", map(self.params_key, param_grid))
+        rows = self.db.execute(
+            "SELECT params, recording, predicted FROM lookup_params "
+            "JOIN evals ON detector = ? AND params = lookup_params.key",
+            (self.detector_key(algo_name),),
+        )
+        table = {(p, r): v for p, r, v in rows}
+
+        recording_keys = [self.recording_key(recording) for recording in data]
+        predicted = np.zeros((len(param_grid), len(data)), dtype=np.int32)
+        missing = np.ones(predicted.shape, dtype=bool)
+        for i, params in enumerate(param_grid):
+            params_key = self.params_key(params)
+            for j, recording_key in enumerate(recording_keys):
+                value = table.get((params_key, recording_key))
+                if value is not None:
+                    predicted[i, j] = value
+                    missing[i, j] = False
+
+        return predicted, missing
+
+    def store(self, algo_name, param_grid, data, predicted):
+        """Store step counts of a batch and commit immediately"""
+        detector_key = self.detector_key(algo_name)
+        recording_keys = [self.recording_key(recording) for recording in data]
+        self.db.executemany(
+            "INSERT OR REPLACE INTO evals VALUES (?, ?, ?, ?)",
+            [
+                (detector_key, self.params_key(params), recording_key, int(value))
+                for params, row in zip(param_grid, predicted)
+                for recording_key, value in zip(recording_keys, row)
+            ],
+        )
+        self.db.commit()
+
+
+class RunStats:
+    """Throughput, latency and overhead statistics of a calibration run"""
+
+    def __init__(self, n_workers):
+        self.n_workers = n_workers
+        self.tasks = []
+        self.busy_time = 0.0
+        self.parent_time = 0.0
+        self.wait_time = 0.0
+
+    def record(self, algorithm, n_evals, submitted, timing):
+        """Record a finished task with its submission time and worker timing"""
+        done = time.perf_counter()
+        self.tasks.append((algorithm, n_evals, submitted, done, timing))
+        self.busy_time += timing["end"] - timing["start"]
+
+    @staticmethod
+    def histogram(latencies):
+        """Histogram of latencies in milliseconds over power-of-two bins"""
+        edges = [0] + LATENCY_BINS + [np.inf]
+        counts, _ = np.histogram(np.array(latencies) * 1000, bins=edges)
+        labels = [f"<={edge}ms" for edge in LATENCY_BINS] + [f">{LATENCY_BINS[-1]}ms"]
+        return {label: int(n) for label, n in zip(labels, counts) if n}
+
+    def summary(self, wall_time, data=None):
+        """Summarize the run as a JSON compatible dictionary"""
+        algorithms, workers = {}, {}
+        for algorithm, n_evals, submitted, done, timing in self.tasks:
+            busy = timing["end"] - timing["start"]
+            algo = algorithms.setdefault(
+                algorithm,
+                {"tasks": 0, "evaluations": 0, "busy": 0.0, "stage": 0.0, "lat": []},
+            )
+            algo["tasks"] += 1
+            algo["evaluations"] += n_evals
+            algo["busy"] += busy
+            algo["stage"] += timing["stage_time"]
+            algo["lat"].append(done - submitted)
+
+            worker = workers.setdefault(timing["worker"], {"tasks": 0, "busy": 0.0})
+            worker["tasks"] += 1
+            worker["busy"] += busy
+
+        for algo in algorithms.values():
+            latencies = algo.pop("lat")
+            algo.update(
+                evals_per_sec=algo["evaluations"] / max(algo["busy"], 1e-9),
+                stage_fraction=algo.pop("stage") / max(algo["busy"], 1e-9),
+                latency_mean=float(np.mean(latencies)),
+                latency_p95=float(np.percentile(latencies, 95)),
+                latency_hist=self.histogram(latencies),
+            )
+        for worker in workers.values():
+            worker["idle"] = wall_time - worker["busy"]
+
+        summary = {
+            "wall_time": wall_time,
+            "n_workers": self.n_workers,
+            "core_utilization": self.busy_time / (wall_time * self.n_workers),
+            "parent": {"overhead": self.parent_time, "waiting": self.wait_time},
+            "algorithms": algorithms,
+            "workers": workers,
         }
 
-        # Process completed evaluations with progress bar
-        for future in tqdm(
-            as_completed(future_to_params),
-            total=len(param_grid),
-            desc=f"Calibrating {algorithm}",
-            leave=False,
-        ):
-            params = future_to_params[future]
+        # Size of the dataset broadcast to each worker
+        if data is not None:
+            start = time.perf_counter()
+            n_bytes = len(pickle.dumps(data))
+            summary["dataset"] = {
+                "recordings": len(data),
+                "samples": sum(len(mag_series) for mag_series, _, _ in data),
+                "pickled_bytes": n_bytes,
+                "pickle_time": time.perf_counter() - start,
+            }
+
+        return summary
+
+
+class Scheduler:
+    """Schedule evaluations of several searches on one shared process pool"""
+
+    def __init__(self, executor, n_workers, data, batch_size, cache=None, share=False):
+        self.executor = executor
+        self.n_workers = n_workers
+        self.data = data
+        self.batch_size = batch_size
+        self.cache = cache
+        self.stats = RunStats(n_workers)
+        # Step counts shared between searches over overlapping recordings
+        self.shared = {} if share else None
+        self.jobs = {}
+        self.results = {}
+
+    def run(self, searches):
+        """Run searches to completion, interleaving their batches on the pool"""
+        start = time.perf_counter()
+        in_flight = {}
+        self.pbar = tqdm(total=0, desc="Calibrating", leave=False)
+        for name, search in searches.items():
+            self.jobs[name] = {"search": search, "tasks": deque()}
+            self.advance(name, None)
+
+        while in_flight or any(job["tasks"] for job in self.jobs.values()):
+            # Keep the pool busy with batches from all searches in turn
+            while len(in_flight) < 2 * self.n_workers:
+                names = [name for name, job in self.jobs.items() if job["tasks"]]
+                if not names:
+                    break
+                for name in names[: 2 * self.n_workers - len(in_flight)]:
+                    rows, cols = self.jobs[name]["tasks"].popleft()
+                    job = self.jobs[name]
+                    future = self.executor.submit(
+                        eval_algo_batch,
+                        job["algorithm"],
+                        [job["param_grid"][i] for i in rows],
+                        [job["recordings"][j] for j in cols],
+                    )
+                    in_flight[future] = (name, rows, cols, time.perf_counter())
+
+            wait_start = time.perf_counter()
+            done, _ = wait(in_flight, return_when=FIRST_COMPLETED)
+            self.stats.wait_time += time.perf_counter() - wait_start
+            for future in done:
+                name, rows, cols, submitted = in_flight.pop(future)
+                self.complete(name, rows, cols, future, submitted)
+
+        self.pbar.close()
+        # Time of the parent spent on scheduling, caching and searches
+        self.stats.parent_time = time.perf_counter() - start - self.stats.wait_time
+        return self.results
+
+    def advance(self, name, errors):
+        """Send errors to a search and prepare the batches of its next request"""
+        job = self.jobs[name]
+        while True:
             try:
-                results = future.result()
+                algorithm, param_grid, recordings = job["search"].send(errors)
+            except StopIteration as stop:
+                self.results[name] = stop.value
+                del self.jobs[name]
+                return
+
+            data = [self.data[j] for j in recordings]
+            predicted = np.zeros((len(param_grid), len(data)), dtype=np.int32)
+            missing = np.ones(predicted.shape, dtype=bool)
+            if self.cache:
+                predicted, missing = self.cache.lookup(algorithm, param_grid, data)
+            if self.shared is not None:
+                self.lookup_shared(
+                    algorithm, param_grid, recordings, predicted, missing
+                )
+
+            job.update(
+                algorithm=algorithm,
+                param_grid=param_grid,
+                recordings=recordings,
+                predicted=predicted,
+                failed=np.zeros(len(param_grid), dtype=bool),
+                pending=0,
+            )
+
+            # Group parameter combinations by the recordings they miss
+            groups = {}
+            for i, row in enumerate(missing):
+                if row.any():
+                    groups.setdefault(tuple(np.flatnonzero(row)), []).append(i)
+
+            # Split groups into batches that spread over all workers
+            for cols, rows in groups.items():
+                subgrid = [param_grid[i] for i in rows]
+                batch_size = min(
+                    self.batch_size, math.ceil(len(subgrid) / self.n_workers)
+                )
+                for batch in get_batches(algorithm, subgrid, batch_size):
+                    job["tasks"].append(([rows[i] for i in batch], list(cols)))
+                    job["pending"] += 1
+                self.pbar.total += len(rows)
+            self.pbar.refresh()
+
+            if job["pending"] > 0:
+                return
+            errors = self.errors(job)
+
+    def complete(self, name, rows, cols, future, submitted):
+        """Collect the results of a finished batch"""
+        job = self.jobs[name]
+        try:
+            predicted, timing = future.result()
+            job["predicted"][np.ix_(rows, cols)] = predicted
+            self.stats.record(job["algorithm"], predicted.size, submitted, timing)
+            if self.shared is not None:
+                for i, row in zip(rows, predicted):
+                    params = tuple(sorted(job["param_grid"][i].items()))
+                    for j, value in zip(cols, row):
+                        key = job["algorithm"], params, job["recordings"][j]
+                        self.shared[key] = value
+            if self.cache:
+                self.cache.store(
+                    job["algorithm"],
+                    [job["param_grid"][i] for i in rows],
+                    [self.data[job["recordings"][j]] for j in cols],
+                    predicted,
+                )
+        except Exception as e:
+            job["failed"][rows] = True
+            print(f"Error evaluating batch of {len(rows)} parameters: {e}")
+
+        self.pbar.update(len(rows))
+        job["pending"] -= 1
+        if job["pending"] == 0:
+            self.advance(name, self.errors(job))
+
+    def lookup_shared(self, algorithm, param_grid, recordings, predicted, missing):
+        """Fill step counts already computed for other searches"""
+        for i, params in enumerate(param_grid):
+            params = tuple(sorted(params.items()))
+            for k, j in enumerate(recordings):
+                value = self.shared.get((algorithm, params, j))
+                if missing[i, k] and value is not None:
+                    predicted[i, k] = value
+                    missing[i, k] = False
+
+    def errors(self, job):
+        """Absolute errors of a completed request"""
+        true_steps = np.array([self.data[j][1] for j in job["recordings"]])
+        errors = np.abs(job["predicted"] - true_steps).astype(float)
+        errors[job["failed"]] = np.inf
+        return errors
+
+
+class TopK:
+    """Streaming selection of the k parameter combinations with lowest error"""
+
+    def __init__(self, k):
+        self.k = k
+        self.heap = []
+        self.count = 0
+
+    def push(self, params, error):
+        """Offer a candidate, keeping earlier candidates on ties"""
+        # Root of the heap is the worst candidate, and the latest among ties
+        item = (-float(error), -self.count, params)
+        self.count += 1
+        if len(self.heap) < self.k:
+            heapq.heappush(self.heap, item)
+        elif item > self.heap[0]:
+            heapq.heapreplace(self.heap, item)
+
+    def ranked(self):
+        """Get shortlist of (params, error) from best to worst"""
+        return [(params, -error) for error, _, params in sorted(self.heap)[::-1]]
+
+
+class ParetoFront:
+    """Streaming front of parameters not dominated in error, ops and state"""
+
+    def __init__(self, algorithm):
+        self.algorithm = algorithm
+        self.points = []
+
+    def push(self, params, error):
+        """Offer a candidate, keeping earlier candidates on ties"""
+        cost = detectors[self.algorithm].get_cost(params)
+        if cost["ops"] is None:
+            return
+        point = (float(error), cost["ops"], cost["state"])
+        if any(all(a <= b for a, b in zip(p, point)) for p, _ in self.points):
+            return
+        self.points = [
+            (p, q) for p, q in self.points if not all(a <= b for a, b in zip(point, p))
+        ]
+        self.points.append((point, params))
+
+    def ranked(self):
+        """Get front of (params, error) from lowest to highest error"""
+        return [
+            (params, point[0])
+            for point, params in sorted(self.points, key=lambda e: e[0])
+        ]
+
+
+class Selection:
+    """Ranked shortlist and Pareto front of evaluated parameters"""
+
+    def __init__(self, algorithm, k):
+        self.top = TopK(k)
+        self.front = ParetoFront(algorithm)
+
+    def push(self, params, error):
+        """Offer a candidate to shortlist and front"""
+        self.top.push(params, error)
+        self.front.push(params, error)
+
+    def result(self):
+        """Get shortlist and front"""
+        return self.top.ranked(), self.front.ranked()
+
+
+def get_activity(fname):
+    """Get activity of a recording from its file name, e.g. fast or pc"""
+    return fname.split("-")[0]
+
+
+def interleave_activities(data):
+    """Order recordings so that each prefix covers all activities evenly"""
+    activities = {}
+    for j, (_, _, fname) in enumerate(data):
+        activities.setdefault(get_activity(fname), []).append(j)
+
+    order = []
+    queues = list(activities.values())
+    while any(queues):
+        order.extend(queue.pop(0) for queue in queues if queue)
+
+    return order, len(queues)
+
+
+def get_folds(data, n_set1, cv):
+    """Get folds as (name, calibration, held-out) recordings of the scheme"""
+    recordings = range(len(data))
+    if cv == "split":
+        set1, set2 = list(recordings[:n_set1]), list(recordings[n_set1:])
+        return [(1, set1, set2), (2, set2, set1)]
+
+    if cv == "loao":
+        # Hold out all recordings of one activity per fold
+        activities = sorted({get_activity(fname) for _, _, fname in data})
+        return [
+            (
+                activity,
+                [j for j in recordings if get_activity(data[j][2]) != activity],
+                [j for j in recordings if get_activity(data[j][2]) == activity],
+            )
+            for activity in activities
+        ]
+
+    # Stratify k folds by dealing interleaved activities round-robin
+    k = int(cv.split(":")[1])
+    if not 2 <= k <= len(data):
+        raise ValueError(f"Number of folds must be between 2 and {len(data)}")
+    order, _ = interleave_activities(data)
+    folds = []
+    for fold in range(k):
+        held_out = sorted(order[fold::k])
+        calib = [j for j in recordings if j not in held_out]
+        folds.append((fold + 1, calib, held_out))
+
+    return folds
+
+
+def get_rungs(data, eta):
+    """Order recordings and get growing subset sizes for successive halving"""
+    # Interleave activities, so that each subset covers all of them
+    order, n_activities = interleave_activities(data)
+
+    # Start with one recording per activity and grow by eta
+    sizes = []
+    size = n_activities
+    while size < len(order):
+        sizes.append(size)
+        size *= eta
+    sizes.append(len(order))
+
+    return order, sizes
+
+
+def halving_fold(algorithm, data, order, sizes, param_grid, errors, args):
+    """Successive halving on one fold whose first rung is already evaluated"""
+    candidates = np.arange(len(param_grid))
+
+    done = sizes[0]
+    for size in sizes:
+        # Evaluate remaining candidates on recordings not known from other folds
+        new = [j for j in order[done:size] if np.isnan(errors[candidates, j]).any()]
+        if new:
+            errors[np.ix_(candidates, new)] = yield (
+                algorithm,
+                [param_grid[i] for i in candidates],
+                new,
+            )
+        done = size
+
+        subset = order[:size]
+        means = error_means(
+            errors[np.ix_(candidates, subset)], [data[j] for j in subset]
+        )
+        if size == len(order):
+            break
+
+        # Keep best fraction including ties at the cut-off
+        keep = max(args.top_k, int(np.ceil(len(candidates) / args.eta)))
+        cutoff = np.sort(means)[min(keep, len(means)) - 1]
+        candidates = candidates[means <= cutoff]
+
+    select = Selection(algorithm, args.top_k)
+    for i, error in zip(candidates, means):
+        select.push(param_grid[i], error)
+    return select.result()
+
+
+def halving_search(algorithm, data, folds, param_grid, args):
+    """Successive halving: prune candidates on growing subsets of recordings"""
+    rungs = {}
+    for fold, calib, _ in folds:
+        order, sizes = get_rungs([data[j] for j in calib], args.eta)
+        rungs[fold] = [calib[k] for k in order], sizes
+
+    # The full grid is evaluated once on the first rungs of all folds, as in
+    # grid search, and only the pruned candidates per fold after that
+    errors = np.full((len(param_grid), len(data)), np.nan)
+    first = sorted({j for order, sizes in rungs.values() for j in order[: sizes[0]]})
+    errors[:, first] = yield algorithm, param_grid, first
+
+    results = {}
+    for fold, (order, sizes) in rungs.items():
+        results[fold] = yield from halving_fold(
+            algorithm, data, order, sizes, param_grid, errors, args
+        )
+
+    return results
+
+
+def parzen_density(indices, size):
+    """Parzen density over the value indices of an axis with uniform prior"""
+    grid = np.arange(size)
+    density = np.ones(size) / size
+    if len(indices) > 0:
+        bandwidth = max(1.0, size / 10)
+        diffs = (grid[None, :] - np.asarray(indices)[:, None]) / bandwidth
+        kernels = np.exp(-0.5 * diffs**2)
+        density = density + (kernels / kernels.sum(axis=1, keepdims=True)).sum(0)
+
+    return density / density.sum()
+
+
+def tpe_propose(rng, sizes, points, errors, count, seen):
+    """Propose new points maximizing the ratio of good and bad densities"""
+    order = np.argsort(errors, kind="stable")
+    n_good = max(1, int(np.ceil(TPE_GAMMA * len(errors))))
+    good = np.array(points)[order[:n_good]]
+    bad = np.array(points)[order[n_good:]]
+
+    # Draw candidates from the good density and score them per axis
+    n_cand = TPE_CANDIDATES * count
+    candidates = np.zeros((n_cand, len(sizes)), dtype=int)
+    scores = np.zeros(n_cand)
+    for k, size in enumerate(sizes):
+        l_density = parzen_density(good[:, k], size)
+        g_density = parzen_density(bad[:, k], size)
+        candidates[:, k] = rng.choice(size, n_cand, p=l_density)
+        scores += np.log(l_density[candidates[:, k]] / g_density[candidates[:, k]])
+
+    proposals = []
+    for i in np.argsort(-scores, kind="stable"):
+        point = tuple(int(v) for v in candidates[i])
+        if point not in seen and point not in proposals:
+            proposals.append(point)
+        if len(proposals) == count:
+            break
+
+    return proposals
+
+
+def random_points(rng, sizes, count, seen):
+    """Draw random points not evaluated so far"""
+    proposals = []
+    while len(proposals) < count:
+        point = tuple(int(rng.integers(size)) for size in sizes)
+        if point not in seen and point not in proposals:
+            proposals.append(point)
+
+    return proposals
+
 
-                if results["error_mean"] < best_error:
-                    best_error = results["error_mean"]
-                    best_params = params
-            except Exception as e:
-                print(f"Error evaluating parameters {params}: {e}")
-                continue
+def tpe_search(algorithm, data, calib, args):
+    """Model-based search with a tree-structured Parzen estimator"""
+    axes = get_axes(algorithm)
+    names, sizes = list(axes), [len(values) for values in axes.values()]
+    budget = args.budget
+    rng = np.random.default_rng(args.seed)
 
-    return best_params, best_error
+    # Propose enough points per round to keep all workers busy
+    n_round = max(args.workers, budget // 20)
+
+    points, errors = [], []
+    seen = set()
+    select = Selection(algorithm, args.top_k)
+    while len(points) < budget:
+        count = min(n_round, budget - len(points))
+        if len(points) < n_round:
+            proposals = random_points(rng, sizes, count, seen)
+        else:
+            proposals = tpe_propose(rng, sizes, points, errors, count, seen)
+            proposals += random_points(
+                rng, sizes, count - len(proposals), seen | set(proposals)
+            )
+
+        param_grid = [
+            {name: axes[name][i] for name, i in zip(names, point)}
+            for point in proposals
+        ]
+        means = error_means(
+            (yield algorithm, param_grid, calib), [data[j] for j in calib]
+        )
+
+        points.extend(proposals)
+        errors.extend(means)
+        seen.update(proposals)
+        for params, error in zip(param_grid, means):
+            select.push(params, error)
+
+    return select.result()
+
+
+def get_steps(axes):
+    """Get bounds, initial step, resolution and listed values of each axis"""
+    steps = {}
+    for name, values in axes.items():
+        values = sorted(set(values))
+        is_int = all(isinstance(v, int) for v in values)
+        diffs = np.diff(values) if len(values) > 1 else np.zeros(1)
+        spacing = float(np.median(diffs))
+
+        # Evenly spaced axes, up to rounding of integer grids, are refined
+        # continuously, others such as log axes move along their listed values
+        if np.ptp(diffs) <= (1 if is_int else 1e-6 * spacing):
+            resolution = 1 if is_int else spacing / 8
+            steps[name] = (values[0], values[-1], is_int, spacing, resolution, None)
+        else:
+            steps[name] = (0, len(values) - 1, True, 1, 1, values)
+
+    return steps
+
+
+def get_coords(steps, params):
+    """Get positions of parameters on their axes, the nearest index if listed"""
+    coords = {}
+    for name, (_, _, _, _, _, listed) in steps.items():
+        if name not in params:
+            continue
+        value = params[name]
+        if listed is not None:
+            value = int(np.argmin([abs(v - value) for v in listed]))
+        coords[name] = value
+
+    return coords
+
+
+def snap(steps, coords):
+    """Clip positions to the axis bounds and round them to the axis values"""
+    snapped = {}
+    for name, (low, high, is_int, _, _, listed) in steps.items():
+        value = min(max(coords.get(name, (low + high) / 2), low), high)
+        if listed is not None:
+            snapped[name] = listed[int(round(value))]
+        else:
+            snapped[name] = int(round(value)) if is_int else round(float(value), 10)
+
+    return snapped
+
+
+def refine_search(algorithm, data, calib, seeds, args):
+    """Pattern search around seed parameters of previous runs"""
+    steps = get_steps(get_axes(algorithm))
+    step = {name: spacing for name, (_, _, _, spacing, _, _) in steps.items()}
+    select = Selection(algorithm, args.top_k)
+    seen = {}
+
+    # Parameters of changed detectors are snapped to the current grid
+    proposals = [snap(steps, get_coords(steps, params)) for params in seeds]
+    proposals = proposals or [snap(steps, {})]
+    center, center_error = None, np.inf
+    while len(seen) < args.budget:
+        param_grid = []
+        for params in proposals:
+            key = json.dumps(params, sort_keys=True)
+            if key not in seen and len(seen) + len(param_grid) < args.budget:
+                seen[key] = None
+                param_grid.append(params)
+
+        improved = False
+        if param_grid:
+            means = error_means(
+                (yield algorithm, param_grid, calib), [data[j] for j in calib]
+            )
+            for params, error in zip(param_grid, means):
+                select.push(params, error)
+                if error < center_error:
+                    center, center_error = params, error
+                    improved = True
+
+        # Shrink the pattern if no neighbor improves the center
+        if not improved:
+            step = {name: size / 2 for name, size in step.items()}
+        if all(step[name] < steps[name][4] for name in steps if step[name] > 0):
+            break
+
+        coords = get_coords(steps, center)
+        proposals = [
+            snap(steps, {**coords, name: coords[name] + sign * step[name]})
+            for name in steps
+            if step[name] >= steps[name][4] and step[name] > 0
+            for sign in (-1, 1)
+        ]
+
+    return select.result()
+
+
+def grid_search(algorithm, data, folds, param_grid, top_k):
+    """Exhaustive search over the parameter grid for all folds at once"""
+    # Evaluate each combination once on the union of calibration recordings
+    recordings = sorted({j for _, calib, _ in folds for j in calib})
+    columns = {j: k for k, j in enumerate(recordings)}
+    errors = yield algorithm, param_grid, recordings
+
+    results = {}
+    for fold, calib, _ in folds:
+        fold_errors = errors[:, [columns[j] for j in calib]]
+        means = error_means(fold_errors, [data[j] for j in calib])
+        select = Selection(algorithm, top_k)
+        for params, error in zip(param_grid, means):
+            select.push(params, error)
+        results[fold] = select.result()
+
+    return results
+
+
+def fold_search(fold, search):
+    """Run a search on a single fold and label its result"""
+    return {fold: (yield from search)}
+
+
+def calibrate_algorithm(algorithm, data, folds, args, cache=None, seeds=None):
+    """Get searches for algorithm parameters on the calibration recordings"""
+    # Searches are generators that yield requests (algorithm, grid, recordings),
+    # receive their errors and return a ranked shortlist and Pareto front of
+    # parameters per fold
+    if args.search == "refine":
+        return {
+            (algorithm, fold): fold_search(
+                fold, refine_search(algorithm, data, calib, seeds or [], args)
+            )
+            for fold, calib, _ in folds
+        }
+
+    n_combi = math.prod(len(values) for values in get_axes(algorithm).values())
+    if args.search == "tpe" and args.budget < n_combi:
+        return {
+            (algorithm, fold): fold_search(
+                fold, tpe_search(algorithm, data, calib, args)
+            )
+            for fold, calib, _ in folds
+        }
+
+    # Re-evaluate cached parameters, which only computes new recordings
+    param_grid = []
+    if args.search == "incremental":
+        param_grid = cache.cached_params(algorithm, data)
+    if not param_grid:
+        param_grid = get_param_grid(algorithm, args.max_combi, args.seed)
+
+    if args.search == "halving":
+        return {
+            (algorithm, None): halving_search(algorithm, data, folds, param_grid, args)
+        }
+    return {
+        (algorithm, None): grid_search(algorithm, data, folds, param_grid, args.top_k)
+    }
+
+
+def print_ranked(title, algorithm, folds, data, results, which):
+    """Print shortlist or Pareto front per fold with held-out errors"""
+    print(f"  {title}:")
+    for fold, _, held_out in folds:
+        print(f"    - fold: {fold}")
+        print("      ranked:")
+        for params, error in results[algorithm, fold][which]:
+            held = eval_algo(algorithm, [data[j] for j in held_out], params)
+            print(f"        - params: {params}")
+            print(f"          cost: {detectors[algorithm].get_cost(params)}")
+            print(f"          calibration_error: {error:.2f}")
+            print(f"          eval_error: {held['error_mean']:.2f}")
+
+
+def get_results_path(args, data_dir):
+    """Get file with results of previous runs, stored next to the data directory"""
+    return args.results or data_dir.parent / f"{data_dir.name}.yml"
+
+
+def report_dataset(args, data, folds, results, stored, rate):
+    """Print results of all algorithms on a dataset and get balanced errors"""
+    errors, costs = {}, {}
+
+    # Foot strikes of held-out walking recordings, the same for all detectors
+    strikes = {
+        j: get_strikes(data[j][0], rate)
+        for _, _, held_out in folds
+        for j in held_out
+        if "walking" in data[j][2]
+    }
+    for algorithm in args.algorithms:
+        # Evaluate best parameters of each fold on its held-out recordings
+        best_params, best_errors, evals = [], [], []
+        for fold, _, held_out in folds:
+            params, error = results[algorithm, fold][0][0]
+            best_params.append(params)
+            best_errors.append(error)
+            evals.append(eval_algo(algorithm, [data[j] for j in held_out], params))
+
+        walking_error = np.nanmean([e["walking_error"] for e in evals])
+        non_walking_error = np.nanmean([e["non_walking_error"] for e in evals])
+        balanced_error = np.mean([e["error_mean"] for e in evals])
+        cost = [detectors[algorithm].get_cost(params) for params in best_params]
+
+        # Detection delays of the best parameters on held-out recordings with
+        # foot strikes, that is, walking recordings
+        matched = [
+            get_delays(detectors[algorithm](**params), data[j][0], strikes[j], rate)
+            for (_, _, held_out), params in zip(folds, best_params)
+            for j in held_out
+            if j in strikes
+        ]
+
+        print(f"- algorithm: {algorithm}")
+        print(f"  best_parameters: {best_params}")
+        print(f"  calibration_error: {np.mean(best_errors):.2f}")
+        print(f"  balanced_error: {balanced_error:.2f}")
+        print(f"  walking_error: {walking_error:.2f}")
+        print(f"  non_walking_error: {non_walking_error:.2f}")
+        print(f"  cost: {cost}")
+        delays = np.concatenate([d for d, _ in matched]) if matched else []
+        print(f"  detection_delay_ms: {delay_stats(delays)}")
+        print(f"  unmatched_steps: {sum(n for _, n in matched)}")
+
+        # Recompute per-recording details only for the shortlisted parameters
+        if args.top_k > 1:
+            print_ranked("shortlist", algorithm, folds, data, results, 0)
+        if args.pareto:
+            print_ranked("pareto_front", algorithm, folds, data, results, 1)
+
+        errors[algorithm] = balanced_error
+        stored[algorithm] = {
+            "best_param": best_params,
+            "calib_error": np.mean(best_errors),
+            "eval_error": balanced_error,
+        }
+
+        # Cost of an algorithm is that of its most expensive fold
+        if cost[0]["ops"] is not None:
+            worst = max((c["ops"], c["state"]) for c in cost)
+            costs[algorithm] = (balanced_error, worst)
+
+    # Cheapest algorithm with at most one step more error than the best
+    if costs:
+        best_error = min(error for error, _ in costs.values())
+        algorithm = min(
+            (algo for algo, (error, _) in costs.items() if error <= best_error + 1),
+            key=lambda algo: costs[algo][1],
+        )
+        error, (ops, state) = costs[algorithm]
+        print(
+            f"# cheapest_within_1_step: {algorithm}, balanced_error: {error:.2f}, "
+            f"ops: {ops}, state: {state}"
+        )
+
+    return errors
+
+
+def print_table(algorithms, errors):
+    """Print balanced errors of all algorithms and datasets as Markdown table"""
+    names = list(errors)
+    print("| Algorithm | " + " | ".join(names) + " |")
+    print("|" + "---|" * (len(names) + 1))
+    for algorithm in algorithms:
+        cells = [f"{errors[name][algorithm]:.2f}" for name in names]
+        print(f"| {algorithm} | " + " | ".join(cells) + " |")
+
+    # Best algorithm per dataset for choosing the sensor configuration
+    best = [min(errors[name], key=errors[name].get) for name in names]
+    cells = [f"{errors[name][algo]:.2f} ({algo})" for name, algo in zip(names, best)]
+    print("| **best** | " + " | ".join(cells) + " |")
 
 
 def main():
     """Main function"""
     args = parse_args()
-    set1_data, set2_data = load_data(args.data_dir)
+    cache = EvalCache(args.cache) if args.cache else None
 
-    # Loop through all algorithms
-    for algorithm in args.algorithms:
-        # Mini cross-validation
-        best_params1, best_error1 = calibrate_algorithm(
-            algorithm, set1_data, args.max_combi
+    # Recordings of all datasets are sent once to each worker and referenced
+    # by index, with folds built within each dataset. Datasets are keyed by
+    # path and labeled by name, or by path where names repeat
+    names = [data_dir.name for data_dir in args.data_dir]
+    data, datasets = [], {}
+    for data_dir in args.data_dir:
+        label = data_dir.name if names.count(data_dir.name) == 1 else str(data_dir)
+        set1_data, set2_data = load_data(data_dir)
+        offset = len(data)
+        data += set1_data + set2_data
+        folds = [
+            (
+                fold,
+                [offset + j for j in calib],
+                [offset + j for j in held_out],
+            )
+            for fold, calib, held_out in get_folds(
+                set1_data + set2_data, len(set1_data), args.cv
+            )
+        ]
+        datasets[data_dir.resolve()] = (label, data_dir, folds)
+
+    # Calibrate all datasets, algorithms and folds on one shared pool
+    start = time.perf_counter()
+    n_workers = args.workers
+    if args.farm:
+        # Workers on other hosts import this module and receive data by hash
+        executor = FarmExecutor(
+            args.farm, "calibrate", "init_worker", (data, args.profile)
+        )
+    else:
+        executor = ProcessPoolExecutor(
+            n_workers, initializer=init_worker, initargs=(data, args.profile)
         )
-        results1 = eval_algo(algorithm, set2_data, best_params1)
-        best_params2, best_error2 = calibrate_algorithm(
-            algorithm, set2_data, args.max_combi
+    with executor:
+        # Grid and halving search cover all folds at once, searches per fold
+        # share counts on the recordings their folds have in common
+        share = args.search in ("tpe", "refine")
+        scheduler = Scheduler(
+            executor, n_workers, data, args.batch_size, cache, share=share
         )
-        results2 = eval_algo(algorithm, set1_data, best_params2)
+        # Refine search starts from the best parameters of previous runs
+        stored, searches = {}, {}
+        for name, (_, data_dir, folds) in datasets.items():
+            stored[name] = load_results(get_results_path(args, data_dir))
+            for algorithm in args.algorithms:
+                seeds = stored[name].get(algorithm, {}).get("best_param", [])
+                dataset_searches = calibrate_algorithm(
+                    algorithm, data, folds, args, cache, seeds
+                )
+                for key, search in dataset_searches.items():
+                    searches[(name,) + key] = search
+        results = {}
+        for (name, algorithm, _), fold_results in scheduler.run(searches).items():
+            for fold, result in fold_results.items():
+                results[name, algorithm, fold] = result
+    wall_time = time.perf_counter() - start
 
-        best_error = (best_error1 + best_error2) / 2
-        error_mean = (results1["error_mean"] + results2["error_mean"]) / 2
+    errors = {}
+    for name, (label, data_dir, folds) in datasets.items():
+        if len(datasets) > 1:
+            print(f"# dataset: {data_dir}")
+        dataset_results = {
+            (algorithm, fold): result
+            for (dataset, algorithm, fold), result in results.items()
+            if dataset == name
+        }
+        rate = get_sample_rate(data_dir)
+        errors[label] = report_dataset(
+            args, data, folds, dataset_results, stored[name], rate
+        )
 
-        print(f"- algorithm: {algorithm}")
-        print(f"  best_parameters: [{best_params1}, {best_params2}]")
-        print(f"  calibration_error: {best_error:.2f}")
-        print(f"  balanced_error: {error_mean:.2f}")
-        print(f"  walking_error: {results1['walking_error']:.2f}")
-        print(f"  non_walking_error: {results1['non_walking_error']:.2f}")
+        # Write refined results back for the next warm start
+        if args.search == "refine":
+            save_results(get_results_path(args, data_dir), stored[name])
+
+    if len(datasets) > 1:
+        print_table(args.algorithms, errors)
+
+    utilization = scheduler.stats.busy_time / (wall_time * n_workers)
+    print(f"# wall_time: {wall_time:.1f} s, core_utilization: {utilization:.0%}")
+
+    if args.stats:
+        summary = scheduler.stats.summary(wall_time, data)
+        json.dump(convert_numpy_types(summary), open(args.stats, "w"), indent=2)
 
 
 if __name__ == "__main__":
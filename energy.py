@@ -0,0 +1,248 @@
+#!/usr/bin/env python3
+"""
+Energy Model of Step Counting
+
+This script estimates the average current of step counting for each sensor
+configuration in the recordings. It combines approximate LIS2DW12 datasheet
+currents, CPU time of the norm and the detectors on the watch based on
+runtime/math_bench.c, and EEPROM programs and erases of the logging face as
+measured by watch-face/host/wear. The estimates
+are joined with the errors of calibrate.py to choose configurations by
+battery life and error together.
+
+Copyright (c) 2025 Konrad Rieck. MIT License
+"""
+
+import argparse
+import ast
+from pathlib import Path
+
+import pandas as pd
+
+from algorithms.registry import detectors
+from calibrate import load_results
+from parse import get_rate
+
+# Current of the LIS2DW12 in µA per data rate for low-power modes 1 to 4,
+# approximated from the datasheet
+LP_CURRENT = {
+    1.6: (0.38, 0.52, 0.78, 1.3),
+    12.5: (1.0, 1.6, 2.7, 4.9),
+    25: (1.6, 2.8, 5.0, 9.5),
+    50: (3.0, 5.2, 9.6, 18.5),
+}
+
+# Current in high-performance mode, about the same at all data rates
+HP_CURRENT = 90.0
+
+# Low-noise mode raises the current in low-power modes by about a fifth
+LOW_NOISE_FACTOR = 1.2
+
+# Time of a norm on the watch in µs: 9 s (L1) and 14 s (approximate L2) for
+# 197 x 10,000 readings in math_bench, loop overhead included
+NORM_US = {"l1": 9e6 / 1_970_000, "l2": 14e6 / 1_970_000}
+
+# Time of a detector operation, as the approximate L2 norm takes about 15
+OP_US = NORM_US["l2"] / 15
+
+# Active current of the SAM L22 at 4 MHz in µA
+CPU_CURRENT = 160.0
+
+# EEPROM pages and rows in bytes, page write and row erase times in ms, and
+# current while writing, waiting CPU included
+PAGE_SIZE = 64
+ROW_SIZE = 256
+PROG_MS = 2.5
+ERASE_MS = 6.0
+NVM_CURRENT = 1000.0
+
+
+def parse_args():
+    # Parse command line arguments
+    parser = argparse.ArgumentParser(description="Estimate energy of step counting")
+    parser.add_argument(
+        "--battery",
+        type=float,
+        default=90.0,
+        help="Battery capacity in mAh (default: 90, CR2016)",
+    )
+    parser.add_argument(
+        "--base-ua",
+        type=float,
+        default=0.0,
+        help="Current of the watch without step counting in µA (default: 0)",
+    )
+    parser.add_argument(
+        "--wear",
+        type=Path,
+        metavar="<file>",
+        default=Path("watch-face/host/wear.yml"),
+        help="Results of the wear harness, ideal packing of pages and rows if "
+        "missing (default: watch-face/host/wear.yml)",
+    )
+    parser.add_argument(
+        "--strategy",
+        type=str,
+        default="sample",
+        help="Logging strategy in the wear results (default: sample, as the face)",
+    )
+    parser.add_argument(
+        "--logging",
+        action="store_true",
+        help="Include EEPROM writes of the logging face in the total",
+    )
+    parser.add_argument(
+        "data_dirs",
+        type=Path,
+        nargs="*",
+        metavar="<dir>",
+        help="Directories with recordings (default: all with results)",
+    )
+
+    args = parser.parse_args()
+    if not args.data_dirs:
+        args.data_dirs = sorted(
+            p.parent / p.stem
+            for p in Path("recordings").glob("*.yml")
+            if (p.parent / p.stem).is_dir()
+        )
+
+    return args
+
+
+def load_header(data_dir):
+    """Load the log header of the first recording of a directory"""
+    path = sorted(data_dir.glob("*.csv"))[0]
+    row = pd.read_csv(path, nrows=1)
+    return ast.literal_eval(row["Header"][0])
+
+
+def load_wear(path, strategy):
+    """Load pages programmed and rows erased per logged byte of a strategy"""
+    name = None
+    for line in path.read_text().splitlines():
+        if not line.startswith(" "):
+            name = line.rstrip(":")
+        elif name == strategy and line.strip().startswith("per_minute:"):
+            fields = line.split("{", 1)[1].rstrip("}").split(",")
+            per_minute = {
+                key.strip(): float(value)
+                for key, value in (field.split(":") for field in fields)
+            }
+            return (
+                per_minute["progs"] / per_minute["bytes"],
+                per_minute["erases"] / per_minute["bytes"],
+            )
+    raise ValueError(f"No strategy {strategy} in {path}")
+
+
+def sensor_current(state, rate):
+    """Current of the accelerometer for a device state"""
+    if state["mode"] == 0b01:
+        return HP_CURRENT
+
+    # On-demand mode converts with the low-power settings
+    current = LP_CURRENT[rate][state["low_power"]]
+    if state["low_noise"]:
+        current *= LOW_NOISE_FACTOR
+    return current
+
+
+def log_current(header, rate, wear):
+    """Current of EEPROM writes of the logging face"""
+    # Each FIFO read once per second logs a count and the samples
+    sample_bytes = 6 * bool(header["data_type"] & 0x01)
+    sample_bytes += 3 * bool(header["data_type"] & 0x02)
+    log_bytes = rate * sample_bytes + 1
+
+    # Programs and erases per logged byte as measured on littlefs, or full
+    # pages and rows without any overhead
+    progs, erases = wear or (1 / PAGE_SIZE, 1 / ROW_SIZE)
+    busy_ms = log_bytes * (progs * PROG_MS + erases * ERASE_MS)
+    return NVM_CURRENT * busy_ms / 1e3
+
+
+def cpu_current(us_per_sample, rate):
+    """Current of the CPU for a time per sample"""
+    return CPU_CURRENT * us_per_sample * rate / 1e6
+
+
+def estimate(data_dir, wear, args):
+    """Estimate currents of all algorithms with results for a directory"""
+    header = load_header(data_dir)
+    state = header["device_state"]
+    rate = get_rate(header)
+    norm = "l1" if header["data_type"] & 0x04 else "l2"
+
+    sensor = sensor_current(state, rate)
+    norm_cpu = cpu_current(NORM_US[norm], rate)
+    log = log_current(header, rate, wear)
+
+    print(f"- dataset: {data_dir.name}")
+    print(f"  rate: {rate}")
+    print(f"  device_state: {state}")
+    print(f"  norm: {norm}")
+    print(f"  sensor_ua: {sensor:.2f}")
+    print(f"  norm_ua: {norm_cpu:.3f}")
+    print(f"  log_ua: {log:.2f}")
+
+    rows = []
+    stored = load_results(data_dir.parent / f"{data_dir.name}.yml")
+    for algorithm, entry in stored.items():
+        if algorithm not in detectors:
+            continue
+        # Parameters of the folds differ in cost, the most expensive counts
+        costs = [detectors[algorithm].get_cost(p) for p in entry["best_param"]]
+        if any(cost["ops"] is None for cost in costs):
+            continue
+        ops = max(cost["ops"] for cost in costs)
+        cpu = norm_cpu + cpu_current(ops * OP_US, rate)
+        total = sensor + cpu + (log if args.logging else 0)
+        days = args.battery * 1e3 / (total + args.base_ua) / 24
+        rows.append((data_dir.name, algorithm, sensor, cpu, total, days, entry))
+
+    return rows
+
+
+def pareto_front(rows):
+    """Rows not dominated in current and error by any other row"""
+    points = [(row[4], row[6]["eval_error"]) for row in rows]
+    return {
+        i
+        for i, p in enumerate(points)
+        if not any(q[0] <= p[0] and q[1] <= p[1] and q != p for q in points)
+    }
+
+
+def print_table(rows, front):
+    """Print estimates of all datasets and algorithms as Markdown table"""
+    print("| Dataset | Algorithm | Sensor µA | CPU µA | Total µA | Days | Error |")
+    print("|---|---|---|---|---|---|---|")
+    for i, (name, algorithm, sensor, cpu, total, days, entry) in enumerate(rows):
+        mark = "**" if i in front else ""
+        print(
+            f"| {name} | {mark}{algorithm}{mark} | {sensor:.2f} | {cpu:.3f} | "
+            f"{total:.2f} | {days:.0f} | {entry['eval_error']:.2f} |"
+        )
+
+
+def main():
+    """Main function"""
+    args = parse_args()
+
+    wear = None
+    if args.wear.exists():
+        wear = load_wear(args.wear, args.strategy)
+    print(f"- wear: {args.wear if wear else 'none'}")
+
+    rows = []
+    for data_dir in args.data_dirs:
+        rows.extend(estimate(data_dir, wear, args))
+
+    # Configurations by current, the Pareto front of current and error in bold
+    rows.sort(key=lambda row: (row[4], row[6]["eval_error"]))
+    print_table(rows, pareto_front(rows))
+
+
+if __name__ == "__main__":
+    main()
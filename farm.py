@@ -0,0 +1,406 @@
+#!/usr/bin/env python3
+"""
+Calibration Farm
+
+This tool distributes calibration tasks from a coordinator to worker
+processes on several hosts over TCP or Unix sockets. Workers send
+heartbeats, batches of lost workers are dispatched again, and the
+dataset is sent once per worker and cached by its content hash.
+
+Coordinator and workers authenticate each other with a shared secret in
+the environment variable FARM_KEY before any message is unpickled, and
+TCP addresses without a host bind to localhost only.
+
+Copyright (c) 2025 Konrad Rieck. MIT License
+"""
+
+import argparse
+import hashlib
+import importlib
+import multiprocessing
+import os
+import pickle
+import socket
+import sys
+import tempfile
+import threading
+import time
+import traceback
+from collections import deque
+from concurrent.futures import Future
+from multiprocessing.connection import Client, Listener
+from pathlib import Path
+
+# Seconds between heartbeats of a worker
+HEARTBEAT_INTERVAL = 2.0
+
+# Seconds without messages after which a worker is considered lost
+HEARTBEAT_TIMEOUT = 10.0
+
+# Seconds between attempts of a worker to reach the coordinator
+RECONNECT_DELAY = 1.0
+
+# Tasks sent ahead to each worker to hide network latency
+WORKER_SLOTS = 2
+
+# Workers lost while running a task after which the task fails
+MAX_LOSSES = 3
+
+# Environment variable holding the shared secret of the farm
+KEY_VARIABLE = "FARM_KEY"
+
+
+def get_authkey():
+    """Get the shared secret of the farm from the environment"""
+    key = os.environ.get(KEY_VARIABLE)
+    if not key:
+        raise ValueError(f"Set {KEY_VARIABLE} to a shared secret of the farm")
+    return key.encode()
+
+
+def parse_address(address):
+    """Parse host:port into a TCP address, anything else is a Unix socket"""
+    host, _, port = str(address).rpartition(":")
+    if port.isdigit():
+        return "AF_INET", (host or "127.0.0.1", int(port))
+    return "AF_UNIX", str(address)
+
+
+def listen(address, authkey):
+    """Open listener for workers that answer the challenge of the key"""
+    family, addr = parse_address(address)
+    if family == "AF_UNIX":
+        # Remove stale socket file of a previous run
+        Path(addr).unlink(missing_ok=True)
+    return Listener(addr, family, authkey=authkey)
+
+
+def connect(address, authkey):
+    """Connect to the coordinator and authenticate with the key"""
+    family, addr = parse_address(address)
+    conn = Client(addr, family, authkey=authkey)
+    if family == "AF_INET":
+        with socket.fromfd(conn.fileno(), socket.AF_INET, socket.SOCK_STREAM) as sock:
+            sock.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+    return conn
+
+
+def send_msg(conn, msg, lock=None):
+    """Send a pickled message"""
+    if lock is None:
+        conn.send(msg)
+        return
+    with lock:
+        conn.send(msg)
+
+
+def recv_msg(conn):
+    """Receive a pickled message of an authenticated peer"""
+    return conn.recv()
+
+
+class FarmExecutor:
+    """Executor that runs module functions on farm workers"""
+
+    def __init__(self, address, module, initializer=None, initargs=(), authkey=None):
+        # Functions are referenced by name in a module importable by workers
+        self.module = module
+        self.initializer = initializer
+        self.payload = pickle.dumps(initargs, protocol=pickle.HIGHEST_PROTOCOL)
+        self.digest = hashlib.sha256(self.payload).hexdigest()
+
+        self.lock = threading.RLock()
+        self.tasks = {}
+        self.losses = {}
+        self.pending = deque()
+        self.workers = {}
+        self.next_id = 0
+        self.closed = False
+
+        self.listener = listen(address, authkey or get_authkey())
+        threading.Thread(target=self.accept_loop, daemon=True).start()
+        threading.Thread(target=self.monitor_loop, daemon=True).start()
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *exc):
+        self.shutdown()
+
+    def submit(self, fn, *args):
+        """Queue a call of a module function and return its future"""
+        future = Future()
+        with self.lock:
+            task_id = self.next_id
+            self.next_id += 1
+            self.tasks[task_id] = (fn.__name__, args, future)
+            self.pending.append(task_id)
+            self.dispatch()
+        return future
+
+    def shutdown(self, wait=True):
+        """Stop all workers and close the listening socket"""
+        with self.lock:
+            self.closed = True
+            for conn in list(self.workers):
+                try:
+                    send_msg(conn, ("stop",))
+                except OSError:
+                    pass
+                self.drop_worker(conn)
+        self.listener.close()
+
+    def dispatch(self):
+        """Send pending tasks to ready workers with free slots"""
+        with self.lock:
+            for conn, worker in list(self.workers.items()):
+                while worker["ready"] and len(worker["tasks"]) < WORKER_SLOTS:
+                    if not self.pending:
+                        return
+                    task_id = self.pending.popleft()
+                    if task_id not in self.tasks:
+                        continue
+                    name, args, future = self.tasks[task_id]
+                    # Running futures cannot be cancelled while results arrive
+                    if (
+                        not future.running()
+                        and not future.set_running_or_notify_cancel()
+                    ):
+                        del self.tasks[task_id]
+                        continue
+                    try:
+                        send_msg(conn, ("task", task_id, name, args))
+                    except OSError:
+                        self.pending.appendleft(task_id)
+                        self.drop_worker(conn)
+                        break
+                    worker["tasks"].add(task_id)
+
+    def drop_worker(self, conn):
+        """Remove a worker and dispatch its tasks again"""
+        with self.lock:
+            worker = self.workers.pop(conn, None)
+            if worker is None:
+                return
+            conn.close()
+            if worker["tasks"] and not self.closed:
+                print(f"Lost worker {worker['name']}, re-dispatching tasks")
+
+            # Fail tasks that keep killing workers instead of the whole farm
+            retry = []
+            for task_id in sorted(worker["tasks"]):
+                self.losses[task_id] = self.losses.get(task_id, 0) + 1
+                if self.losses[task_id] < MAX_LOSSES:
+                    retry.append(task_id)
+                elif task_id in self.tasks:
+                    _, _, future = self.tasks.pop(task_id)
+                    error = RuntimeError(f"Task lost {MAX_LOSSES} workers")
+                    future.set_exception(error)
+            self.pending.extendleft(reversed(retry))
+            self.dispatch()
+
+    def accept_loop(self):
+        """Accept connections of workers"""
+        while not self.closed:
+            try:
+                conn = self.listener.accept()
+            except multiprocessing.AuthenticationError:
+                print("Rejected worker with a wrong key")
+                continue
+            except (OSError, EOFError):
+                if self.closed:
+                    return
+                continue
+            threading.Thread(target=self.serve, args=(conn,), daemon=True).start()
+
+    def monitor_loop(self):
+        """Drop workers whose heartbeats stopped"""
+        while not self.closed:
+            time.sleep(HEARTBEAT_INTERVAL)
+            with self.lock:
+                now = time.monotonic()
+                for conn, worker in list(self.workers.items()):
+                    if now - worker["seen"] > HEARTBEAT_TIMEOUT:
+                        self.drop_worker(conn)
+
+    def serve(self, conn):
+        """Handle messages of one worker connection"""
+        try:
+            _, name, known = recv_msg(conn)
+            with self.lock:
+                if self.closed:
+                    return
+                self.workers[conn] = {
+                    "name": name,
+                    "tasks": set(),
+                    "seen": time.monotonic(),
+                    "ready": False,
+                }
+
+            # Send dataset only if the worker has not cached it yet
+            payload = None if self.digest in known else self.payload
+            init = ("init", self.module, self.initializer, self.digest, payload)
+            send_msg(conn, init)
+
+            while True:
+                msg = recv_msg(conn)
+                with self.lock:
+                    worker = self.workers.get(conn)
+                    if worker is None:
+                        return
+                    worker["seen"] = time.monotonic()
+                    if msg[0] == "ready":
+                        worker["ready"] = True
+                        self.dispatch()
+                    elif msg[0] in ("result", "error"):
+                        _, task_id, value = msg
+                        worker["tasks"].discard(task_id)
+                        task = self.tasks.pop(task_id, None)
+                        self.losses.pop(task_id, None)
+                        self.dispatch()
+                if msg[0] in ("result", "error") and task is not None:
+                    if msg[0] == "result":
+                        task[2].set_result(value)
+                    else:
+                        task[2].set_exception(value)
+        except (OSError, EOFError, pickle.UnpicklingError):
+            pass
+        finally:
+            self.drop_worker(conn)
+
+
+def known_digests(cache_dir):
+    """Get content hashes of datasets cached by a worker"""
+    return [path.stem for path in cache_dir.glob("*.pkl")]
+
+
+def serve_coordinator(conn, cache_dir):
+    """Run tasks of a coordinator until it stops the worker"""
+    lock = threading.Lock()
+    name = f"{socket.gethostname()}:{os.getpid()}"
+    send_msg(conn, ("hello", name, known_digests(cache_dir)), lock)
+
+    # Send heartbeats while tasks are running
+    stopped = threading.Event()
+
+    def heartbeat():
+        while not stopped.wait(HEARTBEAT_INTERVAL):
+            try:
+                send_msg(conn, ("heartbeat",), lock)
+            except OSError:
+                return
+
+    threading.Thread(target=heartbeat, daemon=True).start()
+
+    module = None
+    try:
+        while True:
+            msg = recv_msg(conn)
+            if msg[0] == "stop":
+                return
+            if msg[0] == "init":
+                _, module_name, initializer, digest, payload = msg
+                path = cache_dir / f"{digest}.pkl"
+                if payload is None:
+                    payload = path.read_bytes()
+                else:
+                    path.write_bytes(payload)
+                if hashlib.sha256(payload).hexdigest() != digest:
+                    path.unlink(missing_ok=True)
+                    raise ValueError(f"Corrupt dataset {digest}")
+
+                module = importlib.import_module(module_name)
+                if initializer:
+                    getattr(module, initializer)(*pickle.loads(payload))
+                send_msg(conn, ("ready",), lock)
+            elif msg[0] == "task":
+                _, task_id, name, args = msg
+                try:
+                    reply = ("result", task_id, getattr(module, name)(*args))
+                except Exception:
+                    # Exceptions may not pickle, their traceback always does
+                    reply = ("error", task_id, RuntimeError(traceback.format_exc()))
+                send_msg(conn, reply, lock)
+    finally:
+        stopped.set()
+
+
+def run_worker(address, authkey, cache_dir, once=False):
+    """Serve coordinators at the address, reconnecting after each run"""
+    cache_dir.mkdir(parents=True, exist_ok=True)
+    while True:
+        try:
+            conn = connect(address, authkey)
+        except multiprocessing.AuthenticationError as e:
+            print(f"Coordinator rejected the key: {e}")
+            return
+        except OSError:
+            time.sleep(RECONNECT_DELAY)
+            continue
+
+        try:
+            serve_coordinator(conn, cache_dir)
+        except (OSError, EOFError) as e:
+            print(f"Connection to coordinator lost: {e}")
+        finally:
+            conn.close()
+
+        if once:
+            return
+        time.sleep(RECONNECT_DELAY)
+
+
+def parse_args():
+    # Parse command line arguments
+    parser = argparse.ArgumentParser(description="Worker of a calibration farm")
+    parser.add_argument(
+        "address",
+        type=str,
+        metavar="<address>",
+        help="Coordinator as host:port or path of a Unix socket",
+    )
+    parser.add_argument(
+        "-j",
+        "--jobs",
+        type=int,
+        default=os.cpu_count() or 1,
+        help="Number of worker processes (default: number of cores)",
+    )
+    parser.add_argument(
+        "--cache-dir",
+        type=Path,
+        metavar="<dir>",
+        default=Path(tempfile.gettempdir()) / "stepcounter-farm",
+        help="Directory caching datasets by content hash",
+    )
+    parser.add_argument(
+        "--once",
+        action="store_true",
+        help="Exit after serving one coordinator",
+    )
+    return parser.parse_args()
+
+
+def main():
+    """Main function"""
+    args = parse_args()
+    authkey = get_authkey()
+
+    # Make modules next to this script importable by name
+    sys.path.insert(0, str(Path(__file__).resolve().parent))
+
+    procs = [
+        multiprocessing.Process(
+            target=run_worker,
+            args=(args.address, authkey, args.cache_dir, args.once),
+        )
+        for _ in range(args.jobs)
+    ]
+    for proc in procs:
+        proc.start()
+    for proc in procs:
+        proc.join()
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,415 @@
+#!/usr/bin/env python3
+"""
+Verify Fast Step Detection
+
+This script checks that the fast paths of all step detection algorithms
+(count_steps and sweep_steps), the lockstep kernel of the threshold
+detectors, the step events and the streaming API fed with chunks of
+random size count exactly the same steps as the reference implementation in detect_steps
+on all recordings. With --reference, detect_steps is also compared with the
+plain loops of the detectors at another commit: all 11 detectors match the
+loops of the baseline commit b603c79 exactly on the sampled grids of all
+recordings. With --halving, successive halving of calibrate.py is instead
+compared with grid search on the seeded grid of each dataset, and with
+--farm, grid search on two farm.py workers over a Unix socket, one of them
+killed mid-run, is compared with grid search on a local pool.
+
+Copyright (c) 2025 Konrad Rieck. MIT License
+"""
+
+import argparse
+import importlib
+import inspect
+import os
+import random
+import secrets
+import signal
+import subprocess
+import sys
+import tempfile
+import threading
+import time
+from concurrent.futures import ProcessPoolExecutor
+from pathlib import Path
+
+from algorithms.lockstep import Lockstep
+from algorithms.registry import detectors
+from calibrate import (
+    Scheduler,
+    decode_index,
+    get_axes,
+    get_folds,
+    get_param_grid,
+    grid_search,
+    halving_search,
+    init_worker,
+    load_data,
+)
+from farm import KEY_VARIABLE, FarmExecutor
+
+# Sizes of chunks fed to the streaming API, from single samples to seconds
+CHUNK_SIZES = [1, 2, 3, 16, 64, 250]
+
+# Parameter combinations per task, as by default in calibrate.py
+BATCH_SIZE = 250
+
+
+def parse_args():
+    # Parse command line arguments
+    parser = argparse.ArgumentParser(description="Verify fast step detection")
+    parser.add_argument(
+        "-d",
+        "--data-dir",
+        type=Path,
+        action="append",
+        metavar="<dir>",
+        default=None,
+        help="Directory with recordings, repeatable (default: all in recordings/)",
+    )
+    parser.add_argument(
+        "-n",
+        "--num-params",
+        type=int,
+        default=10,
+        help="Parameter combinations sampled per algorithm (default: 10)",
+    )
+    parser.add_argument(
+        "--seed",
+        type=int,
+        default=0,
+        help="Seed for sampling of parameters (default: 0)",
+    )
+    parser.add_argument(
+        "--reference",
+        type=str,
+        metavar="<commit>",
+        default=None,
+        help="Also compare with detect_steps of the detectors at a commit",
+    )
+    parser.add_argument(
+        "--halving",
+        action="store_true",
+        help="Compare successive halving with grid search instead",
+    )
+    parser.add_argument(
+        "--farm",
+        action="store_true",
+        help="Compare grid search on farm workers, one killed, with a local pool",
+    )
+    parser.add_argument(
+        "--max-combi",
+        type=int,
+        default=20000,
+        help="Maximum number of combinations with --halving or --farm "
+        "(default: 20000)",
+    )
+    parser.add_argument(
+        "--eta",
+        type=int,
+        default=3,
+        help="Reduction factor of successive halving (default: 3)",
+    )
+    parser.add_argument(
+        "--top-k",
+        type=int,
+        default=1,
+        help="Number of best parameters compared per fold (default: 1)",
+    )
+    parser.add_argument(
+        "algorithms",
+        type=str,
+        nargs="*",
+        metavar="<algo>",
+        help=f"Algorithms to verify (default: all). Available: {list(detectors)}",
+    )
+
+    args = parser.parse_args()
+    if not args.data_dir:
+        args.data_dir = sorted(
+            p.parent for p in Path("recordings").glob("*/split.json")
+        )
+    if not args.algorithms:
+        args.algorithms = list(detectors)
+
+    return args
+
+
+def sample_params(algo_name, num_params, rng):
+    """Sample parameters including the first and last grid point"""
+    axes = get_axes(algo_name)
+    n_combi = 1
+    for values in axes.values():
+        n_combi *= len(values)
+
+    indices = {0, n_combi - 1}
+    indices.update(rng.sample(range(n_combi), min(num_params, n_combi)))
+    return [decode_index(axes, i) for i in sorted(indices)]
+
+
+def load_reference(commit):
+    """Load the detectors of a commit from git by class name"""
+    # The modules are imported as a package of their own next to algorithms
+    package = Path(tempfile.mkdtemp()) / "reference_algorithms"
+    package.mkdir()
+    files = subprocess.run(
+        ["git", "ls-tree", "--name-only", commit, "algorithms/"],
+        capture_output=True,
+        text=True,
+        check=True,
+    ).stdout.split()
+    for name in files:
+        if name.endswith(".py"):
+            source = subprocess.run(
+                ["git", "show", f"{commit}:{name}"], capture_output=True, check=True
+            ).stdout
+            (package / Path(name).name).write_bytes(source)
+    sys.path.insert(0, str(package.parent))
+
+    base = importlib.import_module("reference_algorithms.base").BaseDetector
+    reference = {}
+    for path in package.glob("*.py"):
+        module = importlib.import_module(f"reference_algorithms.{path.stem}")
+        for name, obj in inspect.getmembers(module, inspect.isclass):
+            if issubclass(obj, base) and obj is not base:
+                reference[name] = obj
+    return reference
+
+
+def feed_chunks(detector, mag_series, rng):
+    """Feed a series in chunks of random size and get the final count"""
+    detector.reset()
+    index = 0
+    while index < len(mag_series):
+        size = rng.choice(CHUNK_SIZES)
+        detector.feed(mag_series[index : index + size])
+        index += size
+    return detector.count
+
+
+def verify_algorithm(algo_name, data, param_grid, rng, reference=None):
+    """Compare fast and reference step counts and get mismatches and timing"""
+    detector_class = detectors[algo_name]
+    reference_class = (reference or {}).get(detector_class.__name__)
+    sweep_param = detector_class.sweep_param
+    mismatches = []
+    ref_time, fast_time = 0.0, 0.0
+
+    # Run all sampled parameters of threshold detectors in lockstep
+    fused = None
+    if detector_class().lockstep_params() is not None:
+        kernel = Lockstep([detector_class(**params) for params in param_grid])
+        fused = [kernel.run(mag_series) for mag_series, _, _ in data]
+
+    for k, params in enumerate(param_grid):
+        detector = detector_class(**params)
+        for j, (mag_series, _, fname) in enumerate(data):
+            start = time.perf_counter()
+            expected = detector.detect_steps(mag_series)
+            ref_time += time.perf_counter() - start
+
+            start = time.perf_counter()
+            counts = {"count_steps": detector.count_steps(mag_series)}
+            fast_time += time.perf_counter() - start
+            counts["feed"] = feed_chunks(detector, mag_series, rng)
+            counts["events"] = len(detector.detect_events(mag_series))
+            if fused is not None:
+                counts["lockstep"] = int(fused[j][k])
+            if reference_class is not None:
+                ref_detector = reference_class(**params)
+                counts["reference"] = ref_detector.detect_steps(mag_series)
+
+            if sweep_param:
+                signal = detector.preprocess(mag_series)
+                swept = detector.sweep_steps(signal, [params[sweep_param]])
+                counts["sweep_steps"] = int(swept[0])
+
+            for method, steps in counts.items():
+                if steps != expected:
+                    mismatches.append((fname, params, method, steps, expected))
+
+    return mismatches, ref_time, fast_time
+
+
+def run_search(executor, data, search):
+    """Run a search on the pool and get its results per fold"""
+    scheduler = Scheduler(executor, os.cpu_count() or 1, data, BATCH_SIZE)
+    start = time.perf_counter()
+    (results,) = scheduler.run({"search": search}).values()
+    return results, time.perf_counter() - start
+
+
+def load_datasets(data_dirs):
+    """Load recordings of all datasets with the folds of each, as calibrate.py"""
+    data, datasets = [], []
+    for data_dir in data_dirs:
+        set1_data, set2_data = load_data(data_dir)
+        offset = len(data)
+        data += set1_data + set2_data
+        folds = [
+            (fold, [offset + j for j in calib], [offset + j for j in held_out])
+            for fold, calib, held_out in get_folds(
+                set1_data + set2_data, len(set1_data), "split"
+            )
+        ]
+        datasets.append((data_dir.name, folds))
+
+    return data, datasets
+
+
+def verify_halving(args):
+    """Compare shortlists and fronts of successive halving and grid search"""
+    data, datasets = load_datasets(args.data_dir)
+
+    failed = False
+    with ProcessPoolExecutor(initializer=init_worker, initargs=(data,)) as executor:
+        for name, folds in datasets:
+            for algo_name in args.algorithms:
+                param_grid = get_param_grid(algo_name, args.max_combi, args.seed)
+                grid, grid_time = run_search(
+                    executor,
+                    data,
+                    grid_search(algo_name, data, folds, param_grid, args.top_k),
+                )
+                halving, halving_time = run_search(
+                    executor,
+                    data,
+                    halving_search(algo_name, data, folds, param_grid, args),
+                )
+
+                diffs = [fold for fold in grid if grid[fold] != halving[fold]]
+                status = "ok" if not diffs else "MISMATCH"
+                print(
+                    f"{name}/{algo_name}: {status}, {len(param_grid)} params, "
+                    f"halving {halving_time:.1f} s, grid {grid_time:.1f} s"
+                )
+                for fold in diffs:
+                    print(f"  fold {fold}: halving {halving[fold][0]}")
+                    print(f"  fold {fold}: grid {grid[fold][0]}")
+                failed |= bool(diffs)
+
+    sys.exit(1 if failed else 0)
+
+
+def grid_searches(data, datasets, args):
+    """Get grid searches of all datasets and algorithms on the seeded grid"""
+    return {
+        (name, algo_name): grid_search(
+            algo_name,
+            data,
+            folds,
+            get_param_grid(algo_name, args.max_combi, args.seed),
+            args.top_k,
+        )
+        for name, folds in datasets
+        for algo_name in args.algorithms
+    }
+
+
+def kill_worker(executor, workers, killed):
+    """Kill a farm worker once both workers run tasks and one has finished"""
+    while workers[0].poll() is None:
+        with executor.lock:
+            running = len(executor.workers) == len(workers) and all(
+                worker["tasks"] for worker in executor.workers.values()
+            )
+            finished = executor.next_id - len(executor.tasks)
+            if running and finished > 0:
+                os.killpg(workers[0].pid, signal.SIGKILL)
+                killed.append(finished)
+                return
+        time.sleep(0.01)
+
+
+def verify_farm(args):
+    """Compare grid search on two farm workers, one killed, with a local pool"""
+    data, datasets = load_datasets(args.data_dir)
+
+    with ProcessPoolExecutor(initializer=init_worker, initargs=(data,)) as executor:
+        scheduler = Scheduler(executor, os.cpu_count() or 1, data, BATCH_SIZE)
+        local = scheduler.run(grid_searches(data, datasets, args))
+
+    # Workers with their own process group are killed including their pool
+    tmp_dir = Path(tempfile.mkdtemp())
+    address = str(tmp_dir / "farm.sock")
+    authkey = secrets.token_hex(16)
+    env = {**os.environ, KEY_VARIABLE: authkey}
+    farm = Path(__file__).resolve().parent / "farm.py"
+    killed = []
+    with FarmExecutor(
+        address, "calibrate", "init_worker", (data, None), authkey.encode()
+    ) as executor:
+        workers = [
+            subprocess.Popen(
+                [sys.executable, farm, "-j", "1", "--once"]
+                + ["--cache-dir", tmp_dir / f"cache-{k}", address],
+                env=env,
+                start_new_session=True,
+            )
+            for k in range(2)
+        ]
+        threading.Thread(
+            target=kill_worker, args=(executor, workers, killed), daemon=True
+        ).start()
+        scheduler = Scheduler(executor, len(workers), data, BATCH_SIZE)
+        remote = scheduler.run(grid_searches(data, datasets, args))
+    for worker in workers:
+        worker.wait()
+
+    failed = not killed
+    if killed:
+        print(f"# killed a worker with tasks in flight after {killed[0]} results")
+    else:
+        print("# run finished before a worker could be killed")
+    for (name, algo_name), results in local.items():
+        diffs = [
+            fold for fold in results if results[fold] != remote[name, algo_name][fold]
+        ]
+        print(f"{name}/{algo_name}: {'ok' if not diffs else 'MISMATCH'}")
+        for fold in diffs:
+            print(f"  fold {fold}: farm {remote[name, algo_name][fold][0]}")
+            print(f"  fold {fold}: local {results[fold][0]}")
+        failed |= bool(diffs)
+
+    sys.exit(1 if failed else 0)
+
+
+def main():
+    """Main function"""
+    args = parse_args()
+    if args.halving:
+        verify_halving(args)
+    if args.farm:
+        verify_farm(args)
+    rng = random.Random(args.seed)
+    reference = load_reference(args.reference) if args.reference else None
+
+    data = []
+    for data_dir in args.data_dir:
+        set1_data, set2_data = load_data(data_dir)
+        data += [
+            (mag_series, steps, f"{data_dir.name}/{fname}")
+            for mag_series, steps, fname in set1_data + set2_data
+        ]
+
+    failed = False
+    for algo_name in args.algorithms:
+        param_grid = sample_params(algo_name, args.num_params, rng)
+        mismatches, ref_time, fast_time = verify_algorithm(
+            algo_name, data, param_grid, rng, reference
+        )
+
+        status = "ok" if not mismatches else "MISMATCH"
+        speedup = ref_time / max(fast_time, 1e-9)
+        print(
+            f"{algo_name}: {status}, {len(param_grid)} params x {len(data)} "
+            f"recordings, speedup {speedup:.1f}x"
+        )
+        for fname, params, method, steps, expected in mismatches[:10]:
+            print(f"  {fname} {params}: {method} {steps} != {expected}")
+        failed |= bool(mismatches)
+
+    sys.exit(1 if failed else 0)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,172 @@
+/*
+ * Emulated EEPROM of the Sensor Watch with littlefs on top. Reads, programs
+ * and erases are counted per block, and the movement file system helpers
+ * are implemented on littlefs as on the watch.
+ * Copyright (c) 2025 Konrad Rieck. MIT License
+ */
+
+#include <string.h>
+
+#include "eeprom.h"
+#include "filesystem.h"
+#include "host.h"
+
+lfs_t eeprom_filesystem;
+host_lfs_stats_t host_lfs_stats;
+eeprom_stats_t eeprom_blocks[EEPROM_ROWS];
+uint32_t eeprom_bad_progs;
+
+static uint8_t memory[EEPROM_ROWS][EEPROM_ROW_SIZE];
+
+/* Block device */
+static int _read(const struct lfs_config *cfg, lfs_block_t block, lfs_off_t off,
+                 void *buffer, lfs_size_t size)
+{
+    (void) cfg;
+    memcpy(buffer, &memory[block][off], size);
+    eeprom_blocks[block].reads++;
+    eeprom_blocks[block].read_bytes += size;
+    return 0;
+}
+
+static int _prog(const struct lfs_config *cfg, lfs_block_t block, lfs_off_t off,
+                 const void *buffer, lfs_size_t size)
+{
+    (void) cfg;
+    const uint8_t *data = buffer;
+
+    /* Programming only clears bits, as on flash */
+    for (lfs_size_t i = 0; i < size; i++) {
+        if ((memory[block][off + i] & data[i]) != data[i])
+            eeprom_bad_progs++;
+        memory[block][off + i] &= data[i];
+    }
+    eeprom_blocks[block].progs++;
+    eeprom_blocks[block].prog_bytes += size;
+    return 0;
+}
+
+static int _erase(const struct lfs_config *cfg, lfs_block_t block)
+{
+    (void) cfg;
+    memset(memory[block], 0xff, EEPROM_ROW_SIZE);
+    eeprom_blocks[block].erases++;
+    return 0;
+}
+
+static int _sync(const struct lfs_config *cfg)
+{
+    (void) cfg;
+    return 0;
+}
+
+static const struct lfs_config lfs_cfg = {
+    .read = _read,
+    .prog = _prog,
+    .erase = _erase,
+    .sync = _sync,
+    .read_size = EEPROM_READ_SIZE,
+    .prog_size = EEPROM_PAGE_SIZE,
+    .block_size = EEPROM_ROW_SIZE,
+    .block_count = EEPROM_ROWS,
+    .block_cycles = 100,
+    .cache_size = EEPROM_PAGE_SIZE,
+    .lookahead_size = 16,
+};
+
+void eeprom_reset_stats(void)
+{
+    memset(eeprom_blocks, 0, sizeof(eeprom_blocks));
+    memset(&host_lfs_stats, 0, sizeof(host_lfs_stats));
+    eeprom_bad_progs = 0;
+}
+
+/* Erase the EEPROM and mount a fresh file system */
+bool eeprom_format(void)
+{
+    if (eeprom_filesystem.cfg)
+        lfs_unmount(&eeprom_filesystem);
+
+    memset(memory, 0xff, sizeof(memory));
+    if (lfs_format(&eeprom_filesystem, &lfs_cfg) < 0)
+        return false;
+    if (lfs_mount(&eeprom_filesystem, &lfs_cfg) < 0)
+        return false;
+
+    eeprom_reset_stats();
+    return true;
+}
+
+/* Counting wrappers */
+int host_lfs_file_open(lfs_t *lfs, lfs_file_t *file, const char *path, int flags)
+{
+    host_lfs_stats.open++;
+    return lfs_file_open(lfs, file, path, flags);
+}
+
+lfs_ssize_t host_lfs_file_write(lfs_t *lfs, lfs_file_t *file, const void *buffer,
+                                lfs_size_t size)
+{
+    host_lfs_stats.write++;
+    lfs_ssize_t ret = lfs_file_write(lfs, file, buffer, size);
+    if (ret > 0)
+        host_lfs_stats.bytes += ret;
+    return ret;
+}
+
+int host_lfs_file_sync(lfs_t *lfs, lfs_file_t *file)
+{
+    host_lfs_stats.sync++;
+    return lfs_file_sync(lfs, file);
+}
+
+int host_lfs_file_close(lfs_t *lfs, lfs_file_t *file)
+{
+    host_lfs_stats.close++;
+    return lfs_file_close(lfs, file);
+}
+
+int host_lfs_remove(lfs_t *lfs, const char *path)
+{
+    host_lfs_stats.remove++;
+    return lfs_remove(lfs, path);
+}
+
+int host_lfs_rename(lfs_t *lfs, const char *oldpath, const char *newpath)
+{
+    host_lfs_stats.rename++;
+    return lfs_rename(lfs, oldpath, newpath);
+}
+
+/* Movement file system helpers */
+bool filesystem_file_exists(char *filename)
+{
+    struct lfs_info info;
+    return lfs_stat(&eeprom_filesystem, filename, &info) >= 0;
+}
+
+int32_t filesystem_get_file_size(char *filename)
+{
+    struct lfs_info info;
+    if (lfs_stat(&eeprom_filesystem, filename, &info) < 0)
+        return -1;
+    return info.size;
+}
+
+bool filesystem_read_file(char *filename, char *buf, int32_t length)
+{
+    lfs_file_t file;
+    if (lfs_file_open(&eeprom_filesystem, &file, filename, LFS_O_RDONLY) < 0)
+        return false;
+    lfs_ssize_t ret = lfs_file_read(&eeprom_filesystem, &file, buf, length);
+    lfs_file_close(&eeprom_filesystem, &file);
+    return ret == length;
+}
+
+int32_t filesystem_get_free_space(void)
+{
+    lfs_ssize_t used = lfs_fs_size(&eeprom_filesystem);
+    if (used < 0)
+        return used;
+    return (EEPROM_ROWS - used) * EEPROM_ROW_SIZE;
+}
@@ -0,0 +1,53 @@
+/*
+ * Emulated EEPROM of the Sensor Watch with littlefs on top. Reads, programs
+ * and erases are counted per block.
+ * Copyright (c) 2025 Konrad Rieck. MIT License
+ */
+
+#ifndef EEPROM_H_
+#define EEPROM_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "lfs.h"
+
+/* Geometry of the RWW EEPROM of the SAM L22, as configured by movement */
+#define EEPROM_READ_SIZE    16
+#define EEPROM_PAGE_SIZE    64
+#define EEPROM_ROW_SIZE     256
+#define EEPROM_ROWS         32
+
+/* Approximate maximum page write and row erase times of the SAM L22 NVM */
+#define EEPROM_PROG_US      2500
+#define EEPROM_ERASE_US     6000
+
+/* Minimum erase cycles of a row of the SAM L22 NVM */
+#define EEPROM_ENDURANCE    25000
+
+typedef struct {
+    uint32_t reads;
+    uint32_t read_bytes;
+    uint32_t progs;
+    uint32_t prog_bytes;
+    uint32_t erases;
+} eeprom_stats_t;
+
+extern eeprom_stats_t eeprom_blocks[EEPROM_ROWS];
+
+/* Programs that would need to set erased bits, not possible on flash */
+extern uint32_t eeprom_bad_progs;
+
+bool eeprom_format(void);
+void eeprom_reset_stats(void);
+
+/* Counting wrappers for the calls of the face into littlefs */
+int host_lfs_file_open(lfs_t *lfs, lfs_file_t *file, const char *path, int flags);
+lfs_ssize_t host_lfs_file_write(lfs_t *lfs, lfs_file_t *file, const void *buffer,
+                                lfs_size_t size);
+int host_lfs_file_sync(lfs_t *lfs, lfs_file_t *file);
+int host_lfs_file_close(lfs_t *lfs, lfs_file_t *file);
+int host_lfs_remove(lfs_t *lfs, const char *path);
+int host_lfs_rename(lfs_t *lfs, const char *oldpath, const char *newpath);
+
+#endif
@@ -0,0 +1,44 @@
+/*
+ * Host harness for the step counter logging face: replay state and
+ * counters shared by the stubs and the simulator.
+ * Copyright (c) 2025 Konrad Rieck. MIT License
+ */
+
+#ifndef HOST_H_
+#define HOST_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "lis2dw.h"
+
+/* Maximum size of the log file kept in RAM */
+#define HOST_FILE_MAX (1 << 20)
+
+/* Calls into the file system and bytes written */
+typedef struct {
+    uint32_t open;
+    uint32_t write;
+    uint32_t sync;
+    uint32_t close;
+    uint32_t remove;
+    uint32_t rename;
+    uint32_t bytes;
+} host_lfs_stats_t;
+
+extern bool host_verbose;
+extern uint32_t host_rtc_time;
+extern lis2dw_device_state_t host_device_state;
+
+/* Samples queued in the FIFO until the next read, extra samples are dropped */
+extern lis2dw_fifo_t host_fifo;
+extern uint32_t host_fifo_dropped;
+void host_fifo_push(lis2dw_reading_t reading);
+
+/* Log file in RAM and capacity of the file system */
+extern host_lfs_stats_t host_lfs_stats;
+extern uint8_t host_file[HOST_FILE_MAX];
+extern uint32_t host_file_size;
+void host_fs_reset(uint32_t capacity);
+
+#endif
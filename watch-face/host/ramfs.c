@@ -0,0 +1,107 @@
+/*
+ * Host stubs of littlefs and the movement file system helpers. The log file
+ * lives in RAM and every call into the file system is counted.
+ * Copyright (c) 2025 Konrad Rieck. MIT License
+ */
+
+#include <string.h>
+
+#include "filesystem.h"
+#include "host.h"
+#include "lfs.h"
+
+lfs_t eeprom_filesystem;
+host_lfs_stats_t host_lfs_stats;
+uint8_t host_file[HOST_FILE_MAX];
+uint32_t host_file_size;
+
+static uint32_t capacity;
+static bool file_exists;
+
+void host_fs_reset(uint32_t size)
+{
+    memset(&host_lfs_stats, 0, sizeof(host_lfs_stats));
+    host_file_size = 0;
+    file_exists = false;
+    capacity = size;
+}
+
+/* littlefs */
+int lfs_file_open(lfs_t *lfs, lfs_file_t *file, const char *path, int flags)
+{
+    (void) lfs;
+    (void) path;
+    host_lfs_stats.open++;
+    if (flags & LFS_O_TRUNC)
+        host_file_size = 0;
+    file_exists = true;
+    file->open = 1;
+    return 0;
+}
+
+lfs_ssize_t lfs_file_write(lfs_t *lfs, lfs_file_t *file, const void *buffer,
+                           lfs_size_t size)
+{
+    (void) lfs;
+    host_lfs_stats.write++;
+    if (!file->open || host_file_size + size > capacity)
+        return -28;     /* LFS_ERR_NOSPC */
+
+    memcpy(host_file + host_file_size, buffer, size);
+    host_file_size += size;
+    host_lfs_stats.bytes += size;
+    return size;
+}
+
+int lfs_file_sync(lfs_t *lfs, lfs_file_t *file)
+{
+    (void) lfs;
+    (void) file;
+    host_lfs_stats.sync++;
+    return 0;
+}
+
+int lfs_file_close(lfs_t *lfs, lfs_file_t *file)
+{
+    (void) lfs;
+    host_lfs_stats.close++;
+    file->open = 0;
+    return 0;
+}
+
+int lfs_remove(lfs_t *lfs, const char *path)
+{
+    (void) lfs;
+    (void) path;
+    host_lfs_stats.remove++;
+    host_file_size = 0;
+    file_exists = false;
+    return 0;
+}
+
+/* Movement file system helpers */
+bool filesystem_file_exists(char *filename)
+{
+    (void) filename;
+    return file_exists;
+}
+
+int32_t filesystem_get_file_size(char *filename)
+{
+    (void) filename;
+    return file_exists ? (int32_t) host_file_size : -1;
+}
+
+bool filesystem_read_file(char *filename, char *buf, int32_t length)
+{
+    (void) filename;
+    if (!file_exists || (uint32_t) length > host_file_size)
+        return false;
+    memcpy(buf, host_file, length);
+    return true;
+}
+
+int32_t filesystem_get_free_space(void)
+{
+    return capacity - host_file_size;
+}
@@ -0,0 +1,123 @@
+/*
+ * Recordings of the step counter logging face, as exported by parse.py.
+ * Copyright (c) 2025 Konrad Rieck. MIT License
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "recording.h"
+
+#define LINE_SIZE 1024
+
+/* Value of a key in the header column of a recording, or a default */
+static uint32_t _header_field(const char *header, const char *key, uint32_t value)
+{
+    char pattern[32];
+    snprintf(pattern, sizeof(pattern), "'%s': ", key);
+    const char *pos = strstr(header, pattern);
+    return pos ? strtoul(pos + strlen(pattern), NULL, 10) : value;
+}
+
+/* Load a recording with the log header given in its first row */
+bool recording_load(const char *path, recording_t *rec)
+{
+    FILE *file = fopen(path, "r");
+    if (!file)
+        return false;
+
+    char line[LINE_SIZE];
+    uint32_t size = 0;
+    memset(rec, 0, sizeof(*rec));
+
+    /* Skip column names */
+    if (!fgets(line, sizeof(line), file)) {
+        fclose(file);
+        return false;
+    }
+
+    while (fgets(line, sizeof(line), file)) {
+        if (rec->len == size) {
+            size = size ? 2 * size : 1024;
+            rec->time = realloc(rec->time, size * sizeof(*rec->time));
+            rec->second = realloc(rec->second, size * sizeof(*rec->second));
+            rec->mag = realloc(rec->mag, size * sizeof(*rec->mag));
+        }
+
+        char *end;
+        rec->time[rec->len] = strtod(line, &end);
+        rec->mag[rec->len] = strtoul(end + 1, &end, 10);
+        if (rec->len == 0) {
+            /* Steps and header are only given in the first row */
+            rec->steps = strtoul(end + 1, NULL, 10);
+            lis2dw_device_state_t *ds = &rec->device_state;
+            ds->mode = _header_field(line, "mode", 0);
+            ds->data_rate = _header_field(line, "data_rate", 0);
+            ds->low_power = _header_field(line, "low_power", 0);
+            ds->bwf_mode = _header_field(line, "bwf_mode", 0);
+            ds->range = _header_field(line, "range", 0);
+            ds->filter = _header_field(line, "filter", 0);
+            ds->low_noise = _header_field(line, "low_noise", 0);
+            rec->data_type = _header_field(line, "data_type", 0x02);    /* Magnitude */
+            rec->index = _header_field(line, "index", 1);
+            rec->start_ts = _header_field(line, "start_ts", 1735689600);
+        }
+        rec->len++;
+    }
+    fclose(file);
+
+    /*
+     * Timestamps are the second of a FIFO read plus the offset of a sample
+     * within it. A read starts at a full second, unless the read is long and
+     * runs into the next second, which then starts again a few samples later.
+     */
+    for (uint32_t i = 0; i < rec->len; i++) {
+        double t = rec->time[i];
+        bool start = i == 0 || t == (uint32_t) t;
+        for (uint32_t j = i + 1; start && j < rec->len && j <= i + LIS2DW_FIFO_SIZE; j++)
+            start = rec->time[j] > t;
+        rec->second[i] = start || i == 0 ? (uint32_t) t : rec->second[i - 1];
+    }
+    return rec->len > 0;
+}
+
+void recording_free(recording_t *rec)
+{
+    free(rec->time);
+    free(rec->second);
+    free(rec->mag);
+    memset(rec, 0, sizeof(*rec));
+}
+
+/* Number of seconds, each ending with a FIFO read */
+uint32_t recording_seconds(const recording_t *rec)
+{
+    return rec->len ? rec->second[rec->len - 1] + 1 : 0;
+}
+
+/* Smallest v with (k * v) >> s == r, exact for k <= 2^s */
+static uint32_t _invert_scaled(uint32_t r, uint32_t k, uint32_t s)
+{
+    return ((r << s) + k - 1) / k;
+}
+
+/* Reading with the given norm on the watch, clipped to the sensor range */
+lis2dw_reading_t recording_reading(uint32_t mag, bool l1)
+{
+    uint32_t ax = mag < INT16_MAX ? mag : INT16_MAX;
+    uint32_t rest = mag - ax, ay, az;
+
+    if (l1) {
+        ay = rest < INT16_MAX ? rest : INT16_MAX;
+        az = rest - ay;
+    } else {
+        /* Fill y up to its largest weighted value before using z */
+        uint32_t max_y = (15 * INT16_MAX) >> 4;
+        ay = _invert_scaled(rest < max_y ? rest : max_y, 15, 4);
+        az = _invert_scaled(rest - ((15 * ay) >> 4), 3, 3);
+    }
+
+    lis2dw_reading_t reading = { ax, ay, az < INT16_MAX ? az : INT16_MAX };
+    return reading;
+}
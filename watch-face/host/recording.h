@@ -0,0 +1,33 @@
+/*
+ * Recordings of the step counter logging face, as exported by parse.py.
+ * Copyright (c) 2025 Konrad Rieck. MIT License
+ */
+
+#ifndef RECORDING_H_
+#define RECORDING_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "lis2dw.h"
+
+typedef struct {
+    double *time;
+    uint32_t *second;   /* Second of the FIFO read of each sample */
+    uint32_t *mag;
+    uint32_t len;
+    uint16_t steps;
+
+    /* Log header */
+    lis2dw_device_state_t device_state;
+    uint8_t data_type;
+    uint8_t index;
+    uint32_t start_ts;
+} recording_t;
+
+bool recording_load(const char *path, recording_t *rec);
+void recording_free(recording_t *rec);
+uint32_t recording_seconds(const recording_t *rec);
+lis2dw_reading_t recording_reading(uint32_t mag, bool l1);
+
+#endif
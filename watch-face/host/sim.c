@@ -0,0 +1,226 @@
+/*
+ * Host simulator for the step counter logging face. Recordings are replayed
+ * through the face's recording loop at their recorded rate, one tick per
+ * second, and the log written by the face is checked against the input.
+ * Copyright (c) 2025 Konrad Rieck. MIT License
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "host.h"
+#include "recording.h"
+
+/* The face is compiled into the simulator to reach its static functions */
+#include "../stepcounter_logging_face.c"
+#undef printf
+
+#define LINE_SIZE 1024
+#define LOG_HEADER_SIZE 16
+
+/* Norm of a reading as logged by the face */
+static uint32_t _reading_norm(lis2dw_reading_t reading, uint8_t data_type)
+{
+    if (data_type & LOG_DATA_L1)
+        return fast_l1_norm(reading);
+    return fast_l2_norm(reading);
+}
+
+/* Send an event to the face */
+static void _send(stepcounter_logging_state_t *state, uint8_t event_type)
+{
+    movement_event_t event = { event_type, 0 };
+    stepcounter_logging_face_loop(event, state);
+}
+
+/* Compare the log with the readings passed to the FIFO */
+static bool _check_log(stepcounter_logging_state_t *state, lis2dw_reading_t *readings,
+                       uint32_t len, uint16_t steps)
+{
+    uint8_t *log = host_file;
+    uint8_t *end = host_file + host_file_size;
+    uint8_t data_type = state->data_type;
+
+    if (host_file_size < LOG_HEADER_SIZE || log[0] != 0x23 || log[1] != 0x42)
+        return false;
+    if (memcmp(log + 3, &host_device_state, sizeof(host_device_state)) != 0)
+        return false;
+    if (log[10] != data_type)
+        return false;
+    log += LOG_HEADER_SIZE;
+
+    uint32_t n = 0;
+    while (log < end && *log != LOG_FILE_MARKER) {
+        uint8_t count = *log++;
+        for (uint8_t i = 0; i < count; i++, n++) {
+            if (n == len)
+                return false;
+            if (data_type & LOG_DATA_XYZ) {
+                if (memcmp(log, &readings[n], 6) != 0)
+                    return false;
+                log += 6;
+            }
+            if (data_type & LOG_DATA_MAG) {
+                uint32_t mag = log[0] | log[1] << 8 | log[2] << 16;
+                if (mag != _reading_norm(readings[n], data_type))
+                    return false;
+                log += 3;
+            }
+        }
+    }
+
+    /* Marker and steps close the log */
+    return n == len && end - log == 3 && log[1] == (steps & 0xff) && log[2] == steps >> 8;
+}
+
+/* Replay a recording and print a report */
+static bool _replay(const char *path, uint32_t capacity, const char *out_dir)
+{
+    recording_t rec;
+    stepcounter_logging_state_t *state = NULL;
+
+    host_fs_reset(capacity);
+    host_fifo_dropped = 0;
+    if (!recording_load(path, &rec)) {
+        fprintf(stderr, "Error: Cannot load recording %s\n", path);
+        return false;
+    }
+
+    /* Sensor state and RTC as at the start of the recording */
+    uint8_t data_type = rec.data_type;
+    host_device_state = rec.device_state;
+    host_rtc_time = rec.start_ts;
+
+    stepcounter_logging_face_setup(0, (void **) &state);
+    state->data_type = data_type;
+    state->index = rec.index;
+    stepcounter_logging_face_activate(state);
+
+    /* Start recording at the start time of the recording */
+    _send(state, EVENT_ALARM_BUTTON_UP);
+
+    uint32_t ticks = recording_seconds(&rec);
+    double *tick_us = calloc(ticks, sizeof(*tick_us));
+    lis2dw_reading_t *logged = calloc(rec.len, sizeof(*logged));
+    uint32_t n_logged = 0, n_clipped = 0, i = 0, tick;
+
+    for (tick = 0; tick < ticks && state->page == PAGE_RECORDING; tick++) {
+        /* Samples of the past second wait in the FIFO for the tick */
+        uint32_t dropped = host_fifo_dropped;
+        for (; i < rec.len && rec.second[i] == tick; i++) {
+            lis2dw_reading_t reading = recording_reading(rec.mag[i], data_type & LOG_DATA_L1);
+            n_clipped += _reading_norm(reading, data_type) != rec.mag[i];
+            host_fifo_push(reading);
+            if (host_fifo_dropped == dropped)
+                logged[n_logged++] = reading;
+            dropped = host_fifo_dropped;
+        }
+        host_rtc_time++;
+
+        struct timespec start, stop;
+        clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &start);
+        _send(state, EVENT_TICK);
+        clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &stop);
+        tick_us[tick] = (stop.tv_sec - start.tv_sec) * 1e6 +
+            (stop.tv_nsec - start.tv_nsec) / 1e3;
+    }
+
+    /* Stop unless the quota stopped the recording, then label steps */
+    bool quota = state->page != PAGE_RECORDING;
+    if (!quota)
+        _send(state, EVENT_ALARM_BUTTON_UP);
+    for (uint32_t s = 0; s < rec.steps; s += 10)
+        _send(state, EVENT_ALARM_BUTTON_DOWN);
+    for (uint32_t s = (rec.steps + 9) / 10 * 10; s > rec.steps; s--)
+        _send(state, EVENT_LIGHT_BUTTON_DOWN);
+    _send(state, EVENT_MODE_BUTTON_UP);
+
+    bool ok = !state->error && _check_log(state, logged, n_logged, rec.steps);
+
+    double total = 0, max = 0;
+    for (uint32_t t = 0; t < tick; t++) {
+        total += tick_us[t];
+        max = tick_us[t] > max ? tick_us[t] : max;
+    }
+
+    const char *name = strrchr(path, '/') ? strrchr(path, '/') + 1 : path;
+    printf("%s:\n", name);
+    printf("  samples: %u\n", rec.len);
+    printf("  logged: %u\n", n_logged);
+    printf("  dropped: %u\n", host_fifo_dropped);
+    printf("  clipped: %u\n", n_clipped);
+    printf("  ticks: %u\n", tick);
+    if (quota)
+        printf("  quota_stop: %u\n", tick);
+    printf("  bytes_written: %u\n", host_lfs_stats.bytes);
+    printf("  lfs_calls: {open: %u, write: %u, sync: %u, close: %u, remove: %u}\n",
+           host_lfs_stats.open, host_lfs_stats.write, host_lfs_stats.sync,
+           host_lfs_stats.close, host_lfs_stats.remove);
+    printf("  tick_cpu_us: {mean: %.2f, max: %.2f}\n", total / tick, max);
+    printf("  roundtrip: %s\n", ok ? "ok" : "FAILED");
+
+    if (out_dir) {
+        char out_path[LINE_SIZE];
+        const char *ext = strrchr(name, '.') ? strrchr(name, '.') : name + strlen(name);
+        snprintf(out_path, sizeof(out_path), "%s/%.*s.scl", out_dir, (int) (ext - name),
+                 name);
+        FILE *out = fopen(out_path, "wb");
+        if (!out || fwrite(host_file, 1, host_file_size, out) != host_file_size) {
+            fprintf(stderr, "Error: Cannot write log %s\n", out_path);
+            ok = false;
+        }
+        if (out)
+            fclose(out);
+    }
+
+    free(state);
+    free(tick_us);
+    free(logged);
+    recording_free(&rec);
+    return ok;
+}
+
+static void _usage(const char *name)
+{
+    fprintf(stderr, "Usage: %s [-v] [-c <bytes>] [-o <dir>] <csv> ...\n", name);
+    fprintf(stderr, "  -c <bytes>  Capacity of the file system (default: 8192)\n");
+    fprintf(stderr, "  -o <dir>    Write the log of each recording to <dir>\n");
+    fprintf(stderr, "  -v          Print output of the face\n");
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t capacity = 8192;
+    const char *out_dir = NULL;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "c:o:v")) != -1) {
+        switch (opt) {
+            case 'c':
+                capacity = strtoul(optarg, NULL, 10);
+                break;
+            case 'o':
+                out_dir = optarg;
+                break;
+            case 'v':
+                host_verbose = true;
+                break;
+            default:
+                _usage(argv[0]);
+                return 2;
+        }
+    }
+
+    if (optind == argc || capacity > HOST_FILE_MAX) {
+        _usage(argv[0]);
+        return 2;
+    }
+
+    int failed = 0;
+    for (int i = optind; i < argc; i++)
+        failed += !_replay(argv[i], capacity, out_dir);
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,159 @@
+/*
+ * Host stubs of movement, the watch library, the RTC and the LIS2DW driver.
+ * Copyright (c) 2025 Konrad Rieck. MIT License
+ */
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "chirpy_tx.h"
+#include "host.h"
+#include "movement.h"
+#include "watch_utility.h"
+
+bool host_verbose;
+uint32_t host_rtc_time;
+lis2dw_device_state_t host_device_state;
+lis2dw_fifo_t host_fifo;
+uint32_t host_fifo_dropped;
+
+const uint16_t NotePeriods[] = { 1136, 238, 0 };
+
+int host_printf(const char *format, ...)
+{
+    if (!host_verbose)
+        return 0;
+
+    va_list args;
+    va_start(args, format);
+    int ret = vprintf(format, args);
+    va_end(args);
+    return ret;
+}
+
+/* Movement */
+bool movement_button_should_sound(void)
+{
+    return false;
+}
+
+void movement_request_tick_frequency(uint8_t freq)
+{
+    (void) freq;
+}
+
+bool movement_default_loop_handler(movement_event_t event)
+{
+    (void) event;
+    return false;
+}
+
+/* Watch library and RTC */
+watch_date_time_t watch_rtc_get_date_time(void)
+{
+    watch_date_time_t date_time = { host_rtc_time };
+    return date_time;
+}
+
+uint32_t watch_utility_date_time_to_unix_time(watch_date_time_t date_time,
+                                              int32_t utc_offset)
+{
+    return date_time.unix_time - utc_offset;
+}
+
+void watch_buzzer_play_note(buzzer_note_t note, uint16_t duration_ms)
+{
+    (void) note;
+    (void) duration_ms;
+}
+
+void watch_set_buzzer_period_and_duty_cycle(uint32_t period, uint8_t duty)
+{
+    (void) period;
+    (void) duty;
+}
+
+void watch_set_buzzer_on(void)
+{
+}
+
+void watch_set_buzzer_off(void)
+{
+}
+
+void watch_set_indicator(watch_indicator_t indicator)
+{
+    (void) indicator;
+}
+
+void watch_clear_indicator(watch_indicator_t indicator)
+{
+    (void) indicator;
+}
+
+void watch_clear_colon(void)
+{
+}
+
+void watch_display_text_with_fallback(watch_position_t location, const char *string,
+                                      const char *fallback)
+{
+    (void) location;
+    (void) fallback;
+    printf("Display: %s\n", string);
+}
+
+/* LIS2DW driver */
+void host_fifo_push(lis2dw_reading_t reading)
+{
+    if (host_fifo.count == LIS2DW_FIFO_SIZE) {
+        host_fifo_dropped++;
+        return;
+    }
+    host_fifo.readings[host_fifo.count++] = reading;
+}
+
+bool lis2dw_read_fifo(lis2dw_fifo_t *fifo)
+{
+    memcpy(fifo, &host_fifo, sizeof(*fifo));
+    return true;
+}
+
+void lis2dw_clear_fifo(void)
+{
+    host_fifo.count = 0;
+}
+
+void lis2dw_enable_fifo(void)
+{
+    host_fifo.count = 0;
+}
+
+void lis2dw_disable_fifo(void)
+{
+}
+
+void lis2dw_get_state(lis2dw_device_state_t *state)
+{
+    *state = host_device_state;
+}
+
+/* Chirpy transmission is not simulated */
+void chirpy_init_encoder(chirpy_encoder_state_t *state,
+                         uint8_t (*get_next_byte)(uint8_t *next_byte))
+{
+    state->get_next_byte = get_next_byte;
+}
+
+uint8_t chirpy_get_next_tone(chirpy_encoder_state_t *state)
+{
+    (void) state;
+    return 255;
+}
+
+uint16_t chirpy_get_tone_period(uint8_t tone)
+{
+    (void) tone;
+    return 0;
+}
@@ -0,0 +1,27 @@
+/*
+ * Host stub of the chirpy transmitter for the watch-face simulator.
+ * Copyright (c) 2025 Konrad Rieck. MIT License
+ */
+
+#ifndef CHIRPY_TX_H_
+#define CHIRPY_TX_H_
+
+#include <stdint.h>
+
+typedef struct {
+    int32_t tick_count;
+    int32_t tick_compare;
+    uint32_t seq_pos;
+    void (*tick_fun)(void *context);
+} chirpy_tick_state_t;
+
+typedef struct {
+    uint8_t (*get_next_byte)(uint8_t *next_byte);
+} chirpy_encoder_state_t;
+
+void chirpy_init_encoder(chirpy_encoder_state_t *state,
+                         uint8_t (*get_next_byte)(uint8_t *next_byte));
+uint8_t chirpy_get_next_tone(chirpy_encoder_state_t *state);
+uint16_t chirpy_get_tone_period(uint8_t tone);
+
+#endif
@@ -0,0 +1,17 @@
+/*
+ * Host stub of the movement file system helpers for the watch-face simulator.
+ * Copyright (c) 2025 Konrad Rieck. MIT License
+ */
+
+#ifndef FILESYSTEM_H_
+#define FILESYSTEM_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+bool filesystem_file_exists(char *filename);
+int32_t filesystem_get_file_size(char *filename);
+bool filesystem_read_file(char *filename, char *buf, int32_t length);
+int32_t filesystem_get_free_space(void);
+
+#endif
@@ -0,0 +1,40 @@
+/*
+ * Host stub of littlefs for the watch-face simulator. Files live in RAM
+ * and every call is counted.
+ * Copyright (c) 2025 Konrad Rieck. MIT License
+ */
+
+#ifndef LFS_H_
+#define LFS_H_
+
+#include <stdint.h>
+
+typedef uint32_t lfs_size_t;
+typedef int32_t lfs_ssize_t;
+
+enum lfs_open_flags {
+    LFS_O_RDONLY = 1,
+    LFS_O_WRONLY = 2,
+    LFS_O_RDWR = 3,
+    LFS_O_CREAT = 0x0100,
+    LFS_O_EXCL = 0x0200,
+    LFS_O_TRUNC = 0x0400,
+    LFS_O_APPEND = 0x0800,
+};
+
+typedef struct {
+    int mounted;
+} lfs_t;
+
+typedef struct {
+    int open;
+} lfs_file_t;
+
+int lfs_file_open(lfs_t *lfs, lfs_file_t *file, const char *path, int flags);
+lfs_ssize_t lfs_file_write(lfs_t *lfs, lfs_file_t *file, const void *buffer,
+                           lfs_size_t size);
+int lfs_file_sync(lfs_t *lfs, lfs_file_t *file);
+int lfs_file_close(lfs_t *lfs, lfs_file_t *file);
+int lfs_remove(lfs_t *lfs, const char *path);
+
+#endif
@@ -0,0 +1,42 @@
+/*
+ * Host stub of the LIS2DW accelerometer driver for the watch-face simulator.
+ * Copyright (c) 2025 Konrad Rieck. MIT License
+ */
+
+#ifndef LIS2DW_H_
+#define LIS2DW_H_
+
+#include <stdint.h>
+
+/* Depth of the hardware FIFO in samples */
+#define LIS2DW_FIFO_SIZE 32
+
+typedef struct {
+    int16_t x;
+    int16_t y;
+    int16_t z;
+} lis2dw_reading_t;
+
+typedef struct {
+    uint8_t count;
+    lis2dw_reading_t readings[LIS2DW_FIFO_SIZE];
+} lis2dw_fifo_t;
+
+/* Configuration as stored in the log header, one byte per field */
+typedef struct {
+    uint8_t mode;
+    uint8_t data_rate;
+    uint8_t low_power;
+    uint8_t bwf_mode;
+    uint8_t range;
+    uint8_t filter;
+    uint8_t low_noise;
+} lis2dw_device_state_t;
+
+bool lis2dw_read_fifo(lis2dw_fifo_t *fifo);
+void lis2dw_clear_fifo(void);
+void lis2dw_enable_fifo(void);
+void lis2dw_disable_fifo(void);
+void lis2dw_get_state(lis2dw_device_state_t *state);
+
+#endif
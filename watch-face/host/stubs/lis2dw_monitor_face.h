@@ -0,0 +1,13 @@
+/*
+ * Host stub of the LIS2DW monitor face for the watch-face simulator.
+ * Copyright (c) 2025 Konrad Rieck. MIT License
+ */
+
+#ifndef LIS2DW_MONITOR_FACE_H_
+#define LIS2DW_MONITOR_FACE_H_
+
+#include <stdbool.h>
+
+#include "lis2dw.h"
+
+#endif
@@ -0,0 +1,61 @@
+/*
+ * Host stub of the movement framework for the watch-face simulator.
+ * Copyright (c) 2025 Konrad Rieck. MIT License
+ */
+
+#ifndef MOVEMENT_H_
+#define MOVEMENT_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "watch.h"
+
+/* Log output of the face is shown only in verbose mode */
+int host_printf(const char *format, ...);
+#define printf host_printf
+
+typedef enum {
+    EVENT_NONE = 0,
+    EVENT_ACTIVATE,
+    EVENT_TICK,
+    EVENT_LOW_ENERGY_UPDATE,
+    EVENT_BACKGROUND_TASK,
+    EVENT_TIMEOUT,
+    EVENT_LIGHT_BUTTON_DOWN,
+    EVENT_LIGHT_BUTTON_UP,
+    EVENT_LIGHT_LONG_PRESS,
+    EVENT_LIGHT_LONG_UP,
+    EVENT_MODE_BUTTON_DOWN,
+    EVENT_MODE_BUTTON_UP,
+    EVENT_MODE_LONG_PRESS,
+    EVENT_MODE_LONG_UP,
+    EVENT_ALARM_BUTTON_DOWN,
+    EVENT_ALARM_BUTTON_UP,
+    EVENT_ALARM_LONG_PRESS,
+    EVENT_ALARM_LONG_UP,
+} movement_event_type_t;
+
+typedef struct {
+    uint8_t event_type;
+    uint8_t subsecond;
+} movement_event_t;
+
+typedef struct {
+    uint8_t wants_background_task;
+} movement_watch_face_advisory_t;
+
+typedef struct {
+    void (*setup)(uint8_t watch_face_index, void **context_ptr);
+    void (*activate)(void *context);
+    bool (*loop)(movement_event_t event, void *context);
+    void (*resign)(void *context);
+    movement_watch_face_advisory_t (*advise)(void *context);
+} watch_face_t;
+
+bool movement_button_should_sound(void);
+void movement_request_tick_frequency(uint8_t freq);
+bool movement_default_loop_handler(movement_event_t event);
+
+#endif
@@ -0,0 +1,55 @@
+/*
+ * Host stub of the watch library for the watch-face simulator.
+ * Copyright (c) 2025 Konrad Rieck. MIT License
+ */
+
+#ifndef WATCH_H_
+#define WATCH_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "lis2dw.h"
+
+typedef enum {
+    BUZZER_NOTE_A5 = 0,
+    BUZZER_NOTE_C7,
+    BUZZER_NOTE_REST,
+} buzzer_note_t;
+
+extern const uint16_t NotePeriods[];
+
+typedef enum {
+    WATCH_INDICATOR_SIGNAL = 0,
+    WATCH_INDICATOR_BELL,
+    WATCH_INDICATOR_PM,
+    WATCH_INDICATOR_24H,
+    WATCH_INDICATOR_LAP,
+} watch_indicator_t;
+
+typedef enum {
+    WATCH_POSITION_FULL = 0,
+    WATCH_POSITION_TOP,
+    WATCH_POSITION_TOP_LEFT,
+    WATCH_POSITION_TOP_RIGHT,
+    WATCH_POSITION_BOTTOM,
+} watch_position_t;
+
+/* Date and time of the real-time clock, kept as Unix time on the host */
+typedef struct {
+    uint32_t unix_time;
+} watch_date_time_t;
+
+watch_date_time_t watch_rtc_get_date_time(void);
+
+void watch_buzzer_play_note(buzzer_note_t note, uint16_t duration_ms);
+void watch_set_buzzer_period_and_duty_cycle(uint32_t period, uint8_t duty);
+void watch_set_buzzer_on(void);
+void watch_set_buzzer_off(void);
+void watch_set_indicator(watch_indicator_t indicator);
+void watch_clear_indicator(watch_indicator_t indicator);
+void watch_clear_colon(void);
+void watch_display_text_with_fallback(watch_position_t location, const char *string,
+                                      const char *fallback);
+
+#endif
@@ -0,0 +1,16 @@
+/*
+ * Host stub of the watch utilities for the watch-face simulator.
+ * Copyright (c) 2025 Konrad Rieck. MIT License
+ */
+
+#ifndef WATCH_UTILITY_H_
+#define WATCH_UTILITY_H_
+
+#include <stdint.h>
+
+#include "watch.h"
+
+uint32_t watch_utility_date_time_to_unix_time(watch_date_time_t date_time,
+                                              int32_t utc_offset);
+
+#endif
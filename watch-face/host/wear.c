@@ -0,0 +1,304 @@
+/*
+ * Flash wear of logging strategies of the step counter logging face.
+ * Recordings are replayed through the face's recording tick on littlefs
+ * with an emulated EEPROM, swapping how each FIFO read is written to the
+ * log, and reads, programs and erases are reported per recorded minute.
+ * Copyright (c) 2025 Konrad Rieck. MIT License
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "eeprom.h"
+#include "filesystem.h"
+#include "host.h"
+#include "recording.h"
+
+/* Calls of the face and the strategies into littlefs are counted */
+#define lfs_file_open host_lfs_file_open
+#define lfs_file_write host_lfs_file_write
+#define lfs_file_sync host_lfs_file_sync
+#define lfs_file_close host_lfs_file_close
+#define lfs_remove host_lfs_remove
+#define lfs_rename host_lfs_rename
+
+/* The face is compiled into the harness to reach its static functions */
+#include "../stepcounter_logging_face.c"
+#undef printf
+
+typedef void (*log_fun_t)(stepcounter_logging_state_t *state, lis2dw_fifo_t *fifo,
+                          uint32_t tick);
+
+typedef struct {
+    const char *name;
+    log_fun_t log;
+} strategy_t;
+
+/* Totals of a strategy over all recordings */
+typedef struct {
+    double minutes;
+    uint32_t errors;
+    uint32_t quota_stops;
+    uint32_t log_mismatches;
+    uint32_t bad_progs;
+    uint64_t lfs_calls;
+    uint64_t bytes;
+    eeprom_stats_t blocks[EEPROM_ROWS];
+} totals_t;
+
+static uint32_t segment_secs = 60;
+
+/* Log of the reference strategy for comparison */
+static char ref_log[HOST_FILE_MAX];
+static int32_t ref_size;
+
+/* One write per sample, as in the face */
+static void _log_sample(stepcounter_logging_state_t *state, lis2dw_fifo_t *fifo,
+                        uint32_t tick)
+{
+    (void) tick;
+    _log_data(state, fifo);
+}
+
+/* One write per FIFO read with the same bytes as the face */
+static void _log_buffered(stepcounter_logging_state_t *state, lis2dw_fifo_t *fifo,
+                          uint32_t tick)
+{
+    (void) tick;
+    uint8_t buffer[1 + LIS2DW_FIFO_SIZE * 9];
+    lfs_size_t size = 0;
+
+    if (fifo->count == 0)
+        return;
+
+    buffer[size++] = fifo->count;
+    for (uint8_t cnt = 0; cnt < fifo->count; cnt++) {
+        if (state->data_type & LOG_DATA_XYZ) {
+            memcpy(buffer + size, &fifo->readings[cnt], 3 * sizeof(int16_t));
+            size += 3 * sizeof(int16_t);
+        }
+
+        if (state->data_type & LOG_DATA_MAG) {
+            uint32_t mag = 0;
+            if (state->data_type & LOG_DATA_L1)
+                mag = fast_l1_norm(fifo->readings[cnt]);
+            else
+                mag = fast_l2_norm(fifo->readings[cnt]);
+            buffer[size++] = (uint8_t) ((mag >> 0) & 0xFF);
+            buffer[size++] = (uint8_t) ((mag >> 8) & 0xFF);
+            buffer[size++] = (uint8_t) ((mag >> 16) & 0xFF);
+        }
+    }
+
+    if (lfs_file_write(&lfs_fs, &state->file, buffer, size) != (lfs_ssize_t) size)
+        state->error = ERROR_WRITE_DATA;
+}
+
+/* One write per FIFO read, synced to survive a reset */
+static void _log_synced(stepcounter_logging_state_t *state, lis2dw_fifo_t *fifo,
+                        uint32_t tick)
+{
+    _log_buffered(state, fifo, tick);
+    lfs_file_sync(&lfs_fs, &state->file);
+}
+
+/* One write per FIFO read, moving the log to a new file every segment */
+static void _log_segmented(stepcounter_logging_state_t *state, lis2dw_fifo_t *fifo,
+                           uint32_t tick)
+{
+    if (tick > 0 && tick % segment_secs == 0) {
+        char name[16];
+        snprintf(name, sizeof(name), "log.%03u", tick / segment_secs);
+        _log_close(state);
+        lfs_rename(&lfs_fs, LOG_FILE_NAME, name);
+
+        /* The segment starts with a header of its own */
+        _start_recording(state);
+    }
+    _log_buffered(state, fifo, tick);
+}
+
+static const strategy_t strategies[] = {
+    { "sample", _log_sample },
+    { "buffered", _log_buffered },
+    { "synced", _log_synced },
+    { "segmented", _log_segmented },
+};
+
+#define NUM_STRATEGIES (sizeof(strategies) / sizeof(strategies[0]))
+
+/* Send an event to the face */
+static void _send(stepcounter_logging_state_t *state, uint8_t event_type)
+{
+    movement_event_t event = { event_type, 0 };
+    stepcounter_logging_face_loop(event, state);
+}
+
+/* Replay a recording with a strategy on a fresh file system */
+static bool _replay(const recording_t *rec, const strategy_t *strategy, totals_t *totals)
+{
+    stepcounter_logging_state_t *state = NULL;
+    lis2dw_fifo_t fifo;
+
+    if (!eeprom_format())
+        return false;
+
+    host_device_state = rec->device_state;
+    host_rtc_time = rec->start_ts;
+    host_fifo_dropped = 0;
+
+    stepcounter_logging_face_setup(0, (void **) &state);
+    state->data_type = rec->data_type;
+    state->index = rec->index;
+    stepcounter_logging_face_activate(state);
+    _send(state, EVENT_ALARM_BUTTON_UP);
+
+    /* Tick of the face with the strategy in place of _log_data */
+    uint32_t ticks = recording_seconds(rec), i = 0, tick;
+    for (tick = 0; tick < ticks && state->page == PAGE_RECORDING; tick++) {
+        for (; i < rec->len && rec->second[i] == tick; i++) {
+            bool l1 = state->data_type & LOG_DATA_L1;
+            host_fifo_push(recording_reading(rec->mag[i], l1));
+        }
+        host_rtc_time++;
+
+        lis2dw_read_fifo(&fifo);
+        strategy->log(state, &fifo, tick);
+        lis2dw_clear_fifo();
+        _enforce_quota(state);
+        _recording_display(state);
+    }
+
+    bool quota = state->page != PAGE_RECORDING;
+    if (!quota)
+        _send(state, EVENT_ALARM_BUTTON_UP);
+    state->steps = rec->steps;
+    _send(state, EVENT_MODE_BUTTON_UP);
+
+    totals->minutes += tick / 60.0;
+    totals->errors += state->error != 0;
+    totals->quota_stops += quota;
+    totals->bad_progs += eeprom_bad_progs;
+    totals->lfs_calls += host_lfs_stats.open + host_lfs_stats.write +
+        host_lfs_stats.sync + host_lfs_stats.close + host_lfs_stats.remove +
+        host_lfs_stats.rename;
+    totals->bytes += host_lfs_stats.bytes;
+    for (uint32_t b = 0; b < EEPROM_ROWS; b++) {
+        totals->blocks[b].reads += eeprom_blocks[b].reads;
+        totals->blocks[b].read_bytes += eeprom_blocks[b].read_bytes;
+        totals->blocks[b].progs += eeprom_blocks[b].progs;
+        totals->blocks[b].prog_bytes += eeprom_blocks[b].prog_bytes;
+        totals->blocks[b].erases += eeprom_blocks[b].erases;
+    }
+
+    /* Logs of one file must match the log of the face, read after counting */
+    static char log[HOST_FILE_MAX];
+    int32_t size = filesystem_get_file_size(LOG_FILE_NAME);
+    if (size < 0 || size > HOST_FILE_MAX || !filesystem_read_file(LOG_FILE_NAME, log, size))
+        size = -1;
+    totals->errors += size < 0;
+    if (strategy == &strategies[0]) {
+        memcpy(ref_log, log, size > 0 ? size : 0);
+        ref_size = size;
+    } else if (strategy->log != _log_segmented) {
+        totals->log_mismatches +=
+            size < 0 || size != ref_size || memcmp(log, ref_log, size) != 0;
+    }
+
+    free(state);
+    return true;
+}
+
+static void _print_totals(const strategy_t *strategy, const totals_t *totals)
+{
+    eeprom_stats_t sum = { 0 };
+    uint32_t hot = 0;
+    for (uint32_t b = 0; b < EEPROM_ROWS; b++) {
+        sum.reads += totals->blocks[b].reads;
+        sum.read_bytes += totals->blocks[b].read_bytes;
+        sum.progs += totals->blocks[b].progs;
+        sum.prog_bytes += totals->blocks[b].prog_bytes;
+        sum.erases += totals->blocks[b].erases;
+        if (totals->blocks[b].erases > totals->blocks[hot].erases)
+            hot = b;
+    }
+
+    double min = totals->minutes;
+    double io_ms = (sum.progs * EEPROM_PROG_US + sum.erases * EEPROM_ERASE_US) / 1e3;
+    double hot_rate = totals->blocks[hot].erases / min;
+
+    printf("%s:\n", strategy->name);
+    printf("  minutes: %.2f\n", min);
+    printf("  errors: %u\n", totals->errors);
+    printf("  quota_stops: %u\n", totals->quota_stops);
+    if (strategy != &strategies[0] && strategy->log != _log_segmented)
+        printf("  log_mismatches: %u\n", totals->log_mismatches);
+    printf("  bad_progs: %u\n", totals->bad_progs);
+    printf("  per_minute: {lfs_calls: %.0f, bytes: %.0f, reads: %.0f, read_bytes: %.0f, "
+           "progs: %.1f, prog_bytes: %.0f, erases: %.2f, io_ms: %.1f}\n",
+           totals->lfs_calls / min, totals->bytes / min, sum.reads / min,
+           sum.read_bytes / min, sum.progs / min, sum.prog_bytes / min,
+           sum.erases / min, io_ms / min);
+    printf("  write_amplification: %.2f\n",
+           totals->bytes ? (double) sum.prog_bytes / totals->bytes : 0);
+    if (hot_rate > 0)
+        printf("  hot_block: {block: %u, erases_per_min: %.3f, endurance_days: %.0f}\n",
+               hot, hot_rate, EEPROM_ENDURANCE / hot_rate / 1440);
+    else
+        printf("  hot_block: {block: %u, erases_per_min: 0}\n", hot);
+}
+
+static void _usage(const char *name)
+{
+    fprintf(stderr, "Usage: %s [-v] [-s <secs>] <csv> ...\n", name);
+    fprintf(stderr, "  -s <secs>  Length of a segment in seconds (default: 60)\n");
+    fprintf(stderr, "  -v         Print output of the face\n");
+}
+
+int main(int argc, char **argv)
+{
+    int opt;
+
+    while ((opt = getopt(argc, argv, "s:v")) != -1) {
+        switch (opt) {
+            case 's':
+                segment_secs = strtoul(optarg, NULL, 10);
+                break;
+            case 'v':
+                host_verbose = true;
+                break;
+            default:
+                _usage(argv[0]);
+                return 2;
+        }
+    }
+
+    if (optind == argc || segment_secs == 0) {
+        _usage(argv[0]);
+        return 2;
+    }
+
+    static totals_t totals[NUM_STRATEGIES];
+    for (int i = optind; i < argc; i++) {
+        recording_t rec;
+        if (!recording_load(argv[i], &rec)) {
+            fprintf(stderr, "Error: Cannot load recording %s\n", argv[i]);
+            return 1;
+        }
+
+        /* The reference strategy runs first on each recording */
+        for (uint32_t s = 0; s < NUM_STRATEGIES; s++) {
+            if (!_replay(&rec, &strategies[s], &totals[s])) {
+                fprintf(stderr, "Error: Cannot format file system\n");
+                return 1;
+            }
+        }
+        recording_free(&rec);
+    }
+
+    for (uint32_t s = 0; s < NUM_STRATEGIES; s++)
+        _print_totals(&strategies[s], &totals[s]);
+    return 0;
+}